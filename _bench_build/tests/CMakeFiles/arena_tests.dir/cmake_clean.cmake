@@ -0,0 +1,12 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/arena_tests.dir/odometry_arena_test.cpp.o"
+  "CMakeFiles/arena_tests.dir/odometry_arena_test.cpp.o.d"
+  "arena_tests"
+  "arena_tests.pdb"
+  "arena_tests[1]_tests.cmake"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/arena_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,5 @@
+if(EXISTS "/root/repo/_bench_build/tests/arena_tests[1]_tests.cmake")
+  include("/root/repo/_bench_build/tests/arena_tests[1]_tests.cmake")
+else()
+  add_test(arena_tests_NOT_BUILT arena_tests_NOT_BUILT)
+endif()
@@ -0,0 +1,7 @@
+add_test([=[OdometryArenaTests.NoHeapTraffic]=]  /root/repo/_bench_build/tests/arena_tests [==[--gtest_filter=OdometryArenaTests.NoHeapTraffic]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[OdometryArenaTests.NoHeapTraffic]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_bench_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[OdometryArenaTests.Reuse]=]  /root/repo/_bench_build/tests/arena_tests [==[--gtest_filter=OdometryArenaTests.Reuse]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[OdometryArenaTests.Reuse]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_bench_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+add_test([=[OdometryArenaTests.Relocate]=]  /root/repo/_bench_build/tests/arena_tests [==[--gtest_filter=OdometryArenaTests.Relocate]==] --gtest_also_run_disabled_tests)
+set_tests_properties([=[OdometryArenaTests.Relocate]=]  PROPERTIES WORKING_DIRECTORY /root/repo/_bench_build/tests SKIP_REGULAR_EXPRESSION [==[\[  SKIPPED \]]==])
+set(  arena_tests_TESTS OdometryArenaTests.NoHeapTraffic OdometryArenaTests.Reuse OdometryArenaTests.Relocate)
@@ -0,0 +1,67 @@
+/**
+ * @file odometry_benchmark.cpp
+ * @brief Measures the steady state cost of processing a frame
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/odometry.h"
+#include "encoder_to_odom/trajectory.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+/// Number of frames processed per measurement
+constexpr int FRAMES = 2000000;
+
+int main()
+{
+    OdometryProcessor processor(1.0373, 0.5065, 2.38462, 100.0, true, false);
+
+    // Gentle curve with both wheels rolling over every so often
+    std::vector<float> left(FRAMES);
+    std::vector<float> right(FRAMES);
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        left[frame] = static_cast<float>((360 * 100 - frame * 7) % 360);
+        right[frame] = static_cast<float>((frame * 9) % 360);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        processor.updateCurrentValue(Motor::LEFT, left[frame]);
+        processor.updateCurrentValue(Motor::RIGHT, right[frame]);
+        processor.updateTimestamp(static_cast<uint16_t>(frame * 20));
+        processor.processData();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+    auto position = processor.getPosition();
+    std::fprintf(stderr, "processData: %.1f ns/frame (x %.3f y %.3f theta %.3f)\n",
+                 nanoseconds / FRAMES, position.x, position.y, position.theta);
+
+    // Same log reconstructed in parallel
+    std::vector<EncoderFrame> frames(FRAMES);
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        frames[frame] = {left[frame], right[frame], static_cast<uint16_t>(frame * 20)};
+    }
+    std::vector<Position> poses(FRAMES);
+    WheelGeometry wheel = {1.0373, 2.38462};
+    TrajectoryConfig config = {{wheel, wheel, 0.5065}, 100.0, true, false, {0.0, 0.0, 0.0}};
+
+    start = std::chrono::steady_clock::now();
+    reconstructTrajectory(config, frames.data(), FRAMES, poses.data());
+    end = std::chrono::steady_clock::now();
+
+    nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+    position = poses.back();
+    std::fprintf(stderr, "reconstructTrajectory: %.1f ns/frame (x %.3f y %.3f theta %.3f)\n",
+                 nanoseconds / FRAMES, position.x, position.y, position.theta);
+    return 0;
+}
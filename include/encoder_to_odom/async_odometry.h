@@ -0,0 +1,306 @@
+/**
+ * @file async_odometry.h
+ * @brief C++20 coroutine interface for awaiting processed frames from an async byte source
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/encoder_packet.h"
+
+#include <array>
+#include <concepts>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <utility>
+
+/// Bytes a ByteChannel can hold before write() stops accepting more
+constexpr size_t BYTE_CHANNEL_CAPACITY = 1024;
+/// Bytes AsyncOdometry reads from its source at a time
+constexpr size_t ASYNC_READ_SIZE = 256;
+
+/**
+ * @brief Single threaded run queue of coroutines that are ready to continue
+ *
+ * Any number of robots can share one executor, each waiting coroutine costs nothing until its
+ * source has data for it.
+ */
+class AsyncExecutor
+{
+  public:
+    /**
+     * @brief Queue a coroutine to be resumed by the next run
+     *
+     * @param handle Coroutine to resume
+     */
+    void post(std::coroutine_handle<> handle);
+
+    /**
+     * @brief Resume queued coroutines until none are left
+     *
+     * @return size_t Number of coroutines resumed
+     */
+    size_t runUntilIdle();
+
+  protected:
+    std::deque<std::coroutine_handle<>> ready;
+};
+
+template <typename T>
+class Async;
+
+/**
+ * @brief Storage of the value an Async coroutine returns
+ *
+ */
+template <typename T>
+struct AsyncResult
+{
+    std::optional<T> value;
+
+    void return_value(T result) { this->value = std::move(result); }
+    T take() { return std::move(*this->value); }
+};
+
+template <>
+struct AsyncResult<void>
+{
+    void return_void() {}
+    void take() {}
+};
+
+/**
+ * @brief Lazily started coroutine that returns a T to whoever awaits it
+ *
+ * Awaiting it starts it and resumes the awaiting coroutine once it returns. The outermost
+ * coroutine of each robot is started with start() and checked with done().
+ */
+template <typename T>
+class Async
+{
+  public:
+    struct promise_type : AsyncResult<T>
+    {
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+
+        Async get_return_object()
+        {
+            return Async(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept
+        {
+            struct Continue
+            {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle)
+                    noexcept
+                {
+                    return handle.promise().continuation;
+                }
+                void await_resume() noexcept {}
+            };
+            return Continue{};
+        }
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    Async(Async&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Async& operator=(Async&& other) noexcept
+    {
+        std::swap(this->handle, other.handle);
+        return *this;
+    }
+    ~Async()
+    {
+        if (this->handle)
+        {
+            this->handle.destroy();
+        }
+    }
+
+    /**
+     * @brief Run the coroutine until it first waits, for coroutines nothing awaits
+     *
+     */
+    void start() { this->handle.resume(); }
+
+    /**
+     * @brief Check if the coroutine has returned
+     *
+     * @return true returned, its value can be taken with result()
+     */
+    bool done() const noexcept { return this->handle.done(); }
+
+    /**
+     * @brief Take the returned value of a coroutine that is done
+     *
+     */
+    T result() { return this->handle.promise().take(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        this->handle.promise().continuation = awaiting;
+        return this->handle;
+    }
+    T await_resume() { return this->handle.promise().take(); }
+
+  private:
+    explicit Async(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief Anything whose read(buffer, size) can be co_awaited for the number of bytes read
+ *
+ * A read must wait until at least one byte is available and return 0 only once the source has
+ * ended.
+ */
+template <typename Source>
+concept AsyncByteSource = requires(Source& source, uint8_t* buffer, size_t size) {
+    {
+        source.read(buffer, size).await_resume()
+    } -> std::convertible_to<size_t>;
+};
+
+/**
+ * @brief Byte pipe between a producer (socket callback, simulator) and an awaiting reader
+ *
+ */
+class ByteChannel
+{
+  public:
+    /**
+     * @brief Create a channel whose reader is resumed on the given executor
+     *
+     * @param executor Executor the reading coroutine runs on
+     */
+    explicit ByteChannel(AsyncExecutor& executor) : executor(executor) {}
+
+    /**
+     * @brief Copy in bytes and wake the reader
+     *
+     * @param data Bytes to add
+     * @param size Number of bytes
+     * @return size_t Number of bytes accepted, less than size once the channel is full
+     */
+    size_t write(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Mark the end of the data, the reader gets 0 once everything before is read
+     *
+     */
+    void close();
+
+    /**
+     * @brief Awaitable returned by read()
+     *
+     */
+    struct ReadAwaitable
+    {
+        ByteChannel& channel;
+        uint8_t* buffer;
+        size_t size;
+
+        bool await_ready() const noexcept
+        {
+            return this->channel.count > 0 || this->channel.closed;
+        }
+        void await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            this->channel.reader = handle;
+        }
+        size_t await_resume() noexcept { return this->channel.take(this->buffer, this->size); }
+    };
+
+    /**
+     * @brief Wait for bytes to be written
+     *
+     * @param buffer Filled with the bytes
+     * @param size Most bytes to read
+     * @return ReadAwaitable awaits the number of bytes read, 0 once closed and empty
+     */
+    ReadAwaitable read(uint8_t* buffer, size_t size) { return {*this, buffer, size}; }
+
+  protected:
+    size_t take(uint8_t* buffer, size_t size) noexcept;
+    void wake();
+
+    AsyncExecutor& executor;
+    std::array<uint8_t, BYTE_CHANNEL_CAPACITY> bytes = {};
+    size_t head = 0;
+    size_t count = 0;
+    bool closed = false;
+    std::coroutine_handle<> reader;
+};
+
+static_assert(AsyncByteSource<ByteChannel>, "ByteChannel must be usable as a byte source");
+
+/**
+ * @brief Decodes encoder packets from an async byte source and awaits processed frames
+ *
+ */
+template <AsyncByteSource Source>
+class AsyncOdometry
+{
+  public:
+    /**
+     * @brief Create an async reader feeding the given processor
+     *
+     * @param processor Processor every decoded frame is run through, must outlive this
+     * @param source Source of encoder packet bytes, must outlive this
+     */
+    AsyncOdometry(OdometryProcessor& processor, Source& source)
+        : processor(processor), source(source)
+    {
+    }
+
+    /**
+     * @brief Wait for the next complete frame and process it
+     *
+     * @return Async<std::optional<OdometryState>> state after the frame, empty once the source
+     * has ended
+     */
+    Async<std::optional<OdometryState>> nextPose()
+    {
+        while (true)
+        {
+            EncoderFrame frame;
+            while (this->offset < this->size)
+            {
+                if (this->decoder.push(this->buffer[this->offset++], frame))
+                {
+                    this->processor.processFrame(frame);
+                    co_return this->processor.state();
+                }
+            }
+
+            this->offset = 0;
+            this->size = co_await this->source.read(this->buffer.data(), this->buffer.size());
+            if (this->size == 0)
+            {
+                co_return std::nullopt;
+            }
+        }
+    }
+
+    /**
+     * @brief Get the counts of the packet decoder
+     *
+     * @return EncoderPacketCounters decoded and thrown out packets
+     */
+    EncoderPacketCounters getCounters() const noexcept { return this->decoder.getCounters(); }
+
+  private:
+    OdometryProcessor& processor;
+    Source& source;
+    EncoderPacketDecoder decoder;
+    std::array<uint8_t, ASYNC_READ_SIZE> buffer = {};
+    size_t offset = 0;
+    size_t size = 0;
+};
@@ -0,0 +1,100 @@
+/**
+ * @file calibration.h
+ * @brief Estimation of wheel geometry from recorded runs with known start and end poses
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+#include <cstddef>
+#include <vector>
+
+/// Max Gauss-Newton iterations used by the calibration solve
+constexpr int CALIBRATION_ITERATIONS = 20;
+
+/**
+ * @brief A single recorded run (such as a UMBmark square) with ground truth end points
+ *
+ */
+struct CalibrationRun
+{
+    /// Encoder degrees traveled by each wheel per frame, forward is positive for both wheels.
+    /// These are deltas with rollovers already unwrapped, not raw readings, so build runs from
+    /// recorded logs with makeCalibrationRun().
+    std::vector<float> leftDegrees;
+    std::vector<float> rightDegrees;
+    /// Measured pose at the start and end of the run
+    Position start;
+    Position end;
+};
+
+/**
+ * @brief Recorded runs of a single robot along with its current geometry
+ *
+ */
+struct CalibrationProblem
+{
+    std::vector<CalibrationRun> runs;
+    float gearRatio;          /// Number of encoder degrees read per 1 degree of wheel travel
+    float wheelCircumference; /// Starting guess for both wheels (meters)
+    float wheelBase;          /// Starting guess (meters)
+};
+
+/**
+ * @brief Wheel geometry that best explains the recorded runs
+ *
+ */
+struct WheelCalibration
+{
+    float leftCircumference;  /// Estimated circumference of the left wheel (meters)
+    float rightCircumference; /// Estimated circumference of the right wheel (meters)
+    float wheelBase;          /// Estimated effective wheel base (meters)
+    float residual;           /// RMS end point error with the estimated geometry
+    int iterations;           /// Number of solver iterations used
+};
+
+/**
+ * @brief Build a run from a recorded encoder log
+ *
+ * The frames are run through an OdometryProcessor, so rollovers and wheel directions are handled
+ * exactly as they are on the robot.
+ *
+ * @param frames Raw frames oldest first, the first frame only gives the starting readings
+ * @param count Number of frames
+ * @param rolloverThreshold Largest reading change that is not a rollover
+ * @param rightIncrease True if the right reading increases when driving forward
+ * @param leftIncrease True if the left reading increases when driving forward
+ * @param start Measured pose at the first frame
+ * @param end Measured pose at the last frame
+ * @return CalibrationRun per frame forward degrees of each wheel
+ */
+CalibrationRun makeCalibrationRun(const EncoderFrame* frames, size_t count,
+                                  float rolloverThreshold, bool rightIncrease, bool leftIncrease,
+                                  const Position& start, const Position& end);
+
+/**
+ * @brief Estimate per wheel circumference and wheel base with a least squares fit of the end
+ * points of each run
+ *
+ * The runs are integrated with the same math as the OdometryProcessor. Runs in both directions
+ * (clockwise and counter clockwise squares) are needed to separate wheel size error from wheel
+ * base error, and at least one run must end away from its start (such as a measured straight
+ * line) to fix the overall scale.
+ *
+ * @param problem Runs and starting geometry of the robot
+ * @return WheelCalibration estimated geometry, the starting geometry if there are no runs
+ */
+WheelCalibration calibrateWheelGeometry(const CalibrationProblem& problem);
+
+/**
+ * @brief Calibrate many robots in parallel
+ *
+ * @param problems Runs and starting geometry of each robot
+ * @param threadCount Number of worker threads, 0 uses the hardware concurrency
+ * @return std::vector<WheelCalibration> result for each problem in the same order
+ */
+std::vector<WheelCalibration> calibrateFleet(const std::vector<CalibrationProblem>& problems,
+                                             unsigned threadCount = 0);
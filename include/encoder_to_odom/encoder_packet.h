@@ -0,0 +1,120 @@
+/**
+ * @file encoder_packet.h
+ * @brief Framing of encoder frames sent over a serial link by the edge device
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+#include <cstddef>
+
+/// Bytes in a decoded packet, uint16 timestamp, float left, float right, uint16 CRC
+constexpr size_t ENCODER_PACKET_PAYLOAD_SIZE = 12;
+/// Most bytes a packet takes on the wire, COBS overhead byte and zero delimiter included
+constexpr size_t ENCODER_PACKET_MAX_SIZE = ENCODER_PACKET_PAYLOAD_SIZE + 2;
+
+/**
+ * @brief Number of packets decoded and thrown out
+ *
+ */
+struct EncoderPacketCounters
+{
+    uint32_t frames;        /// Packets decoded into frames
+    uint32_t crcErrors;     /// Packets with the right length whose CRC did not match
+    uint32_t framingErrors; /// Packets with bad COBS encoding, the wrong length or no delimiter
+};
+
+/**
+ * @brief Calculate the CRC-16/CCITT-FALSE of a block of bytes
+ *
+ * @param data Bytes to check
+ * @param size Number of bytes
+ * @return uint16_t CRC, polynomial 0x1021 starting from 0xFFFF
+ */
+uint16_t crc16(const uint8_t* data, size_t size);
+
+/**
+ * @brief Encode a frame the way the edge device sends it
+ *
+ * The payload is the little endian timestamp, left and right readings followed by the CRC. It is
+ * COBS encoded so the only zero byte on the wire is the delimiter that ends each packet.
+ *
+ * @param frame Frame to send
+ * @param packet Filled with the packet, must hold ENCODER_PACKET_MAX_SIZE bytes
+ * @return size_t Number of bytes written, delimiter included
+ */
+size_t encodeEncoderPacket(const EncoderFrame& frame, uint8_t* packet);
+
+/**
+ * @brief Decodes encoder frames from a serial byte stream as the bytes arrive
+ *
+ * Bytes can be fed in any chunk size, a packet split over several reads is finished when the rest
+ * arrives. Corrupt or partial packets (for example when opening the port mid stream) are counted
+ * and thrown out at the next delimiter, so decoding resyncs by itself. Never allocates.
+ */
+class EncoderPacketDecoder
+{
+  public:
+    /**
+     * @brief Feed a single byte
+     *
+     * @param byte Next byte from the serial link
+     * @param frame Set to the decoded frame when the byte completes a packet
+     * @return true byte completed a valid packet
+     * @return false more bytes are needed or the packet was thrown out
+     */
+    bool push(uint8_t byte, EncoderFrame& frame);
+
+    /**
+     * @brief Feed a block of bytes, decoding until the frames array is full
+     *
+     * @param data Bytes read from the serial link
+     * @param size Number of bytes read
+     * @param frames Filled with decoded frames in order
+     * @param capacity Most frames to decode
+     * @param consumed Set to the number of bytes used, feed the rest once the frames are handled
+     * @return size_t Number of frames decoded
+     */
+    size_t decode(const uint8_t* data, size_t size, EncoderFrame* frames, size_t capacity,
+                  size_t& consumed);
+
+    /**
+     * @brief Feed a block of bytes and process every decoded frame
+     *
+     * @param data Bytes read from the serial link
+     * @param size Number of bytes read
+     * @param processor Processor to run each frame through with processFrame()
+     * @return size_t Number of frames processed
+     */
+    size_t decode(const uint8_t* data, size_t size, OdometryProcessor& processor);
+
+    /**
+     * @brief Throw out any partially received packet, for example after reopening the port
+     *
+     */
+    void reset();
+
+    /**
+     * @brief Get the number of decoded and thrown out packets
+     *
+     * @return EncoderPacketCounters counts since construction
+     */
+    EncoderPacketCounters getCounters() const noexcept { return this->counters; }
+
+  protected:
+    /**
+     * @brief Decode the buffered packet once its delimiter arrives
+     *
+     * @return true packet was valid
+     */
+    bool finishPacket(EncoderFrame& frame);
+
+    uint8_t buffer[ENCODER_PACKET_MAX_SIZE - 1] = {};
+    size_t length = 0;
+    /// Set when a packet ran past the longest valid length, until the next delimiter
+    bool discarding = false;
+    EncoderPacketCounters counters = {};
+};
@@ -0,0 +1,131 @@
+/**
+ * @file event_loop.h
+ * @brief epoll driven reading of an edge device link with a stale encoder watchdog
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/encoder_packet.h"
+
+#include <functional>
+
+/**
+ * @brief Reads encoder packets from a file descriptor and runs them through a processor
+ *
+ * The descriptor (serial port, pipe or socket) and a timerfd watchdog are waited on with epoll.
+ * Every complete packet is processed as soon as its bytes arrive and the frame callback is called
+ * straight from the read, so there is no queue between the link and the callback. If no frame
+ * arrives within the stale timeout the stale callback is called with true, and with false when
+ * frames resume.
+ */
+class OdometryEventLoop
+{
+  public:
+    /**
+     * @brief Create a loop feeding the given processor
+     *
+     * @param processor Processor every decoded frame is run through, must outlive the loop
+     */
+    explicit OdometryEventLoop(OdometryProcessor& processor);
+    ~OdometryEventLoop();
+    OdometryEventLoop(const OdometryEventLoop&) = delete;
+    OdometryEventLoop& operator=(const OdometryEventLoop&) = delete;
+
+    /**
+     * @brief Start watching a descriptor, the loop takes ownership and closes it
+     *
+     * On failure the descriptor and anything created for it are closed, so open can be retried
+     * with a new descriptor.
+     *
+     * @param descriptor Open descriptor of the edge device link, set to non-blocking here
+     * @param staleTimeout Milliseconds without a frame before the encoders are considered stale
+     * @return true loop is ready to run
+     * @return false already open, timeout not positive, descriptor cannot be watched or
+     * epoll/timerfd could not be created
+     */
+    bool open(int descriptor, int staleTimeout);
+
+    /**
+     * @brief Set the function called after each frame is processed
+     *
+     * @param callback Called with the state of the processor after the frame
+     */
+    void onFrame(std::function<void(const OdometryState&)> callback);
+
+    /**
+     * @brief Set the function called when the encoders go stale or recover
+     *
+     * @param callback Called with true when frames stop arriving and false when they resume
+     */
+    void onStale(std::function<void(bool)> callback);
+
+    /**
+     * @brief Wait for and handle a single round of events
+     *
+     * @param timeout Most milliseconds to wait, -1 waits until something happens
+     * @return int Number of frames processed, -1 once the link closed, stop() was called or
+     * epoll failed
+     */
+    int runOnce(int timeout);
+
+    /**
+     * @brief Handle events until the link closes or stop() is called
+     *
+     */
+    void run();
+
+    /**
+     * @brief Make run() return, safe to call from any thread
+     *
+     */
+    void stop();
+
+    /**
+     * @brief Check if no frame has arrived within the stale timeout
+     *
+     * @return true encoders are stale
+     */
+    bool isStale() const noexcept { return this->stale; }
+
+    /**
+     * @brief Get the counts of the packet decoder
+     *
+     * @return EncoderPacketCounters decoded and thrown out packets
+     */
+    EncoderPacketCounters getCounters() const noexcept { return this->decoder.getCounters(); }
+
+  protected:
+    /**
+     * @brief Read everything available on the link and process the frames in it
+     *
+     * @return int Number of frames processed, -1 if the link closed
+     */
+    int readLink();
+
+    /**
+     * @brief Restart the watchdog countdown from now
+     *
+     */
+    void armWatchdog();
+
+    /**
+     * @brief Close the link and every descriptor created for it
+     *
+     */
+    void closeDescriptors();
+
+    OdometryProcessor& processor;
+    EncoderPacketDecoder decoder;
+    std::function<void(const OdometryState&)> frameCallback;
+    std::function<void(bool)> staleCallback;
+
+    int link = -1;
+    int epoll = -1;
+    int watchdog = -1;
+    int wake = -1;
+    int staleTimeout = 0;
+    bool stale = false;
+    bool stopped = false;
+};
@@ -0,0 +1,55 @@
+/**
+ * @file geometry_mailbox.h
+ * @brief Lock free hand off of new drive geometry to a running OdometryProcessor
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+#include <atomic>
+
+/**
+ * @brief Holds the most recently published drive geometry for a processor to pick up
+ *
+ * Any number of threads can publish. The processor reads the geometry at the start of a frame
+ * without ever waiting (sequence lock). A read that overlaps a publish fails and is tried again
+ * next frame, so the processor only ever applies a complete geometry.
+ */
+class GeometryMailbox
+{
+  public:
+    /**
+     * @brief Make new geometry available to the processor, applied at its next frame
+     *
+     * @param geometry Wheel sizes, gearing and wheel base to use
+     */
+    void publish(const DriveGeometry& geometry);
+
+    /**
+     * @brief Get the version of the newest published geometry
+     *
+     * @return uint32_t 0 if nothing has been published yet, increases with each publish
+     */
+    uint32_t version() const;
+
+    /**
+     * @brief Copy out the newest published geometry
+     *
+     * @param geometry Set to the newest geometry
+     * @param version Set to the version of the geometry that was read
+     * @return true a complete geometry was read
+     * @return false nothing has been published or a publish was in progress
+     */
+    bool tryRead(DriveGeometry& geometry, uint32_t& version) const;
+
+  private:
+    /// Number of floats in a DriveGeometry
+    static constexpr int FIELD_COUNT = 5;
+
+    /// Even while stable, odd while a publish is in progress. Version is sequence / 2.
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<float> fields[FIELD_COUNT] = {};
+};
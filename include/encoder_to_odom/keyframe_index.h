@@ -0,0 +1,143 @@
+/**
+ * @file keyframe_index.h
+ * @brief Periodic processor snapshots over a recorded log for random access pose lookups
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+#include <cstddef>
+#include <vector>
+
+/// Identifies a keyframe index file, "ODKI" in little endian
+constexpr uint32_t KEYFRAME_INDEX_MAGIC = 0x494B444F;
+/// Layout of the index file, bumped whenever the fields written change
+constexpr uint32_t KEYFRAME_INDEX_VERSION = 3;
+/// Default frames between keyframes
+constexpr size_t KEYFRAME_INTERVAL = 1000;
+
+/**
+ * @brief Processor state just before a frame of the log was processed
+ *
+ */
+struct Keyframe
+{
+    uint64_t frame;                /// Index of the next frame to process
+    int64_t time;                  /// Timestamp units from the first frame of the log to frame
+    OdometryCheckpoint checkpoint; /// State to carry on integrating from
+};
+
+/**
+ * @brief Answers "where was the robot at time t" over a recorded log without replaying all of it
+ *
+ * The log is the array of EncoderFrames the robot recorded, for example a memory mapped binary
+ * file. Building the index replays it once and keeps a checkpoint of the processor every interval
+ * frames. A lookup restores the closest checkpoint before the time onto a copy of the configured
+ * processor and replays at most interval frames from there. Times are timestamp units since the
+ * first frame, with the 16 bit edge device timestamps unwrapped.
+ */
+class KeyframeIndex
+{
+  public:
+    /**
+     * @brief Replay a log and keep snapshots of the processor along the way
+     *
+     * @param initial Processor as configured before the first frame, any mailbox is detached
+     * @param frames Recorded frames oldest first
+     * @param count Number of frames
+     * @param interval Frames between keyframes
+     * @return true index built
+     * @return false interval is 0
+     */
+    bool build(const OdometryProcessor& initial, const EncoderFrame* frames, size_t count,
+               size_t interval = KEYFRAME_INTERVAL);
+
+    /**
+     * @brief Get the processor as it was after the last frame at or before a time
+     *
+     * @param frames Log the index was built over
+     * @param count Number of frames in the log
+     * @param time Timestamp units since the first frame
+     * @param processor Set to the processor after that frame
+     * @return true processor found
+     * @return false the log does not match the index or time is before the first frame
+     */
+    bool stateAt(const EncoderFrame* frames, size_t count, int64_t time,
+                 OdometryProcessor& processor) const;
+
+    /**
+     * @brief Get the pose at a time, interpolated between the frames around it
+     *
+     * @param frames Log the index was built over
+     * @param count Number of frames in the log
+     * @param time Timestamp units since the first frame
+     * @param pose Set to the pose at time
+     * @return true pose found
+     * @return false the log does not match the index or time is outside the log
+     */
+    bool poseAt(const EncoderFrame* frames, size_t count, int64_t time, Position& pose) const;
+
+    /**
+     * @brief Write the index next to its log
+     *
+     * @param path File to write
+     * @return true written
+     * @return false file could not be written
+     */
+    bool save(const char* path) const;
+
+    /**
+     * @brief Read an index written by save()
+     *
+     * @param path File to read
+     * @param initial Processor configured as it was given to build(), any mailbox is detached
+     * @return true index loaded
+     * @return false file missing, truncated, not an index or an unsupported version
+     */
+    bool load(const char* path, const OdometryProcessor& initial);
+
+    /**
+     * @brief Get the checkpoints
+     *
+     * @return const std::vector<Keyframe>& keyframes oldest first
+     */
+    const std::vector<Keyframe>& getKeyframes() const noexcept { return this->keyframes; }
+
+    /**
+     * @brief Get the time of the last frame of the log
+     *
+     * @return int64_t timestamp units from the first to the last frame
+     */
+    int64_t getDuration() const noexcept { return this->duration; }
+
+  protected:
+    /**
+     * @brief Find the last keyframe at or before a time
+     *
+     * @return const Keyframe* keyframe, nullptr if time is before the first
+     */
+    const Keyframe* findKeyframe(int64_t time) const;
+
+    /**
+     * @brief Replay from a keyframe to the last frame at or before a time
+     *
+     * @return uint64_t index of that frame
+     */
+    uint64_t replay(const Keyframe& keyframe, const EncoderFrame* frames, int64_t time,
+                    OdometryProcessor& processor, int64_t& frameTime) const;
+
+    /**
+     * @brief Processor as configured before the first frame, with no mailbox
+     *
+     */
+    void setInitial(const OdometryProcessor& initial);
+
+    /// Configuration the checkpoints are restored onto, a placeholder until build() or load()
+    OdometryProcessor initial{1.0f, 1.0f, 1.0f, THREE_SIXTY / 2.0f};
+    std::vector<Keyframe> keyframes;
+    uint64_t frameCount = 0;
+    int64_t duration = 0;
+};
@@ -8,15 +8,32 @@
  */
 
 #pragma once
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
-#include <map>
+#include <limits>
 #include <math.h>
+#include <type_traits>
 
 /// @brief  General reusable values
 constexpr float PI = 3.14159265;
 constexpr float THREE_SIXTY = 360.0;
 constexpr int SETTLE_READINGS = 3;
+/// Number of motors tracked by encoders
+constexpr int MOTOR_COUNT = 2;
+/// Number of frame deltas held when checking for stable readings
+constexpr int SETTLE_WINDOW = 4;
+/// Number of timestamped samples kept per wheel for aligning the wheels to a common instant
+constexpr int WHEEL_HISTORY = 4;
+/// Number of past poses kept for looking up the pose at a given time
+constexpr int POSE_HISTORY_SIZE = 128;
+/// Fraction of the measured gyro rate folded into the bias estimate per stationary frame
+constexpr float GYRO_BIAS_GAIN = 0.1;
+/// Wheel speed below which the robot is taken to be standing still for gyro bias learning (m/s)
+constexpr float GYRO_STILL_SPEED = 0.005;
+/// Number of frames in a row that can be rejected before the next one is accepted as real motion
+constexpr int GLITCH_RESYNC_FRAMES = 3;
 
 /**
  * @brief Enum to determine which motor an encoder is attached to
@@ -30,6 +47,101 @@ enum class Motor
     RIGHT
 };
 
+/**
+ * @brief How the processor decides the boot readings are good to use
+ *
+ */
+enum class SettlePolicy
+{
+    FIXED_COUNT,        /// Throw out a fixed number of frames
+    VARIANCE_THRESHOLD, /// Wait until the frame deltas of both wheels are stable over a window
+    IMMEDIATE           /// Use every frame, the first one only sets the starting readings
+};
+
+/**
+ * @brief Fixed size storage of a value for each motor
+ *
+ */
+template <typename T>
+struct MotorValues
+{
+    std::array<T, MOTOR_COUNT> values = {};
+
+    T& operator[](Motor motor) noexcept { return this->values[static_cast<int>(motor)]; }
+    const T& operator[](Motor motor) const noexcept
+    {
+        return this->values[static_cast<int>(motor)];
+    }
+};
+
+/**
+ * @brief Settle policy along with the values it needs
+ *
+ */
+struct SettleConfig
+{
+    SettlePolicy policy = SettlePolicy::FIXED_COUNT;
+    int readings = SETTLE_READINGS; /// Frames to throw out when using FIXED_COUNT
+    float varianceThreshold = 1.0;  /// Max variance (degrees^2) of the frame deltas of each wheel
+                                    /// over SETTLE_WINDOW frames when using VARIANCE_THRESHOLD
+};
+
+/**
+ * @brief How the wheel readings are aligned in time before being integrated
+ *
+ */
+enum class AlignmentMode
+{
+    NONE,   /// Integrate the readings as they came in (both wheels assumed sampled together)
+    LINEAR, /// Linearly interpolate both wheels to a common instant
+    CUBIC   /// Fit a cubic through the last WHEEL_HISTORY samples of each wheel
+};
+
+/**
+ * @brief Single timestamped reading of a wheel
+ *
+ */
+struct WheelSample
+{
+    uint16_t timestamp; /// Timestamp of the reading from the edge device
+    float degrees;      /// Total degrees the wheel had traveled at that time
+};
+
+/**
+ * @brief Readings of both wheels taken together by the edge device
+ *
+ */
+struct EncoderFrame
+{
+    float left;         /// Left encoder angle reading
+    float right;        /// Right encoder angle reading
+    uint16_t timestamp; /// Timestamp of the readings from the edge device (ms)
+};
+
+/**
+ * @brief Small ring of the most recent samples of a wheel
+ *
+ */
+struct WheelHistory
+{
+    std::array<WheelSample, WHEEL_HISTORY> samples = {};
+    int head = 0;  /// Slot the next sample is written to
+    int count = 0; /// Number of valid samples
+
+    /**
+     * @brief Add a sample, dropping the oldest one once full
+     *
+     */
+    void push(uint16_t timestamp, float degrees);
+
+    /**
+     * @brief Get a sample by age
+     *
+     * @param index 0 is the oldest sample, count - 1 the newest
+     */
+    const WheelSample& at(int index) const;
+};
+
 /**
  * @brief Position data of the object from starting point
  *
@@ -61,6 +173,206 @@ struct Distance
     float totalDistance; /// Distance that the system has moved (in meters) since being started
 };
 
+/**
+ * @brief Size of a single drive wheel and its encoder gearing
+ *
+ */
+struct WheelGeometry
+{
+    float circumference; /// Circumference of the wheel (meters)
+    float gearRatio;     /// Number of encoder degrees read per 1 degree of wheel travel
+};
+
+/**
+ * @brief Full drive geometry of the system
+ *
+ */
+struct DriveGeometry
+{
+    WheelGeometry leftWheel;
+    WheelGeometry rightWheel;
+    float wheelBase; /// The distance between the centerpoint of both drive wheels (meters)
+};
+
+class GeometryMailbox;
+
+/**
+ * @brief Constants derived from the geometry and frame timing so each frame only needs multiplies
+ *
+ */
+struct DerivedConstants
+{
+    /// Meters traveled forward per encoder degree of each wheel. Negative for wheels whose readings
+    /// decrease when moving forward.
+    MotorValues<float> metersPerDegree;
+    /// 1 / wheel base (1/m)
+    float inverseWheelBase = 0.0;
+    /// Delta time the frame rate was calculated for
+    int deltaTime = 0;
+    /// 1 / delta time (1/s), not finite until a delta time has been provided
+    float frameRate = std::numeric_limits<float>::infinity();
+};
+
+/**
+ * @brief What to do with a frame that fails validation
+ *
+ */
+enum class GlitchAction
+{
+    REJECT, /// Throw out the frame and measure the next one from the last good readings
+    CLAMP   /// Limit the wheel travel to the closest plausible values
+};
+
+/**
+ * @brief Limits used to decide if a frame is physically plausible, a limit of 0 is not checked
+ *
+ */
+struct ValidationConfig
+{
+    float maxWheelSpeed = 0.0;           /// Fastest a wheel can travel (m/s)
+    float maxWheelAcceleration = 0.0;    /// Largest change in wheel speed (m/s^2)
+    float maxWheelSpeedDifference = 0.0; /// Largest difference between the wheel speeds (m/s)
+    GlitchAction action = GlitchAction::REJECT;
+};
+
+/**
+ * @brief Counts of the frames that failed validation
+ *
+ */
+struct ValidationCounters
+{
+    uint32_t framesChecked = 0;
+    uint32_t speedViolations = 0;
+    uint32_t accelerationViolations = 0;
+    uint32_t speedDifferenceViolations = 0;
+    uint32_t rejectedFrames = 0;
+    uint32_t clampedFrames = 0;
+};
+
+/**
+ * @brief Uncertainty of the pose as a 3x3 covariance matrix
+ *
+ */
+struct PoseCovariance
+{
+    /// Row major covariance of (x, y, theta) in meters and radians
+    std::array<float, 9> values;
+};
+
+/**
+ * @brief Snapshot of everything the processor has calculated as of the latest frame
+ *
+ */
+struct OdometryState
+{
+    Position position;                         /// Pose in the odom coordinate frame
+    Velocity velocity;                         /// Velocity during the latest frame
+    Distance distance;                         /// Distance of the latest frame and since boot
+    MotorValues<float> totalDegreesTraveled;   /// Encoder degrees of each motor since boot
+    MotorValues<float> totalMetersTraveled;    /// Meters of each motor since boot
+    MotorValues<float> degreesTraveledInFrame; /// Encoder degrees of each motor in the latest frame
+    MotorValues<float> metersTraveledInFrame;  /// Meters of each motor in the latest frame
+    uint16_t timestamp;                        /// Edge device timestamp of the latest frame
+};
+
+/**
+ * @brief Pose of the system at a point in time
+ *
+ */
+struct TimedPose
+{
+    int64_t time;  /// Timestamp units since the processor started, does not wrap
+    Position pose; /// Pose at that time
+};
+
+/**
+ * @brief Fixed size ring of the most recent poses
+ *
+ */
+struct PoseHistory
+{
+    std::array<TimedPose, POSE_HISTORY_SIZE> poses = {};
+    int head = 0;  /// Slot the next pose is written to
+    int count = 0; /// Number of valid poses
+
+    /**
+     * @brief Add a pose, dropping the oldest one once full
+     *
+     */
+    void push(int64_t time, const Position& pose);
+
+    /**
+     * @brief Get a pose by age
+     *
+     * @param index 0 is the oldest pose, count - 1 the newest
+     */
+    const TimedPose& at(int index) const;
+};
+
+/**
+ * @brief State a processor needs to carry on integrating frames where another one left off
+ *
+ * Holds no configuration (geometry, policies, limits) and no pose history, so it only restores
+ * onto a processor configured like the one it was taken from.
+ */
+struct OdometryCheckpoint
+{
+    /// Readings and wheel travel
+    MotorValues<float> currentReadings;
+    MotorValues<float> lastReadings;
+    MotorValues<float> totalDegreesTraveled;
+    MotorValues<float> degreesTraveledInFrame;
+    MotorValues<float> totalMetersTraveled;
+    MotorValues<float> metersTraveledInFrame;
+    float previousLeftDegree;
+    float previousRightDegree;
+    bool leftSync;
+    bool rightSync;
+
+    /// Event driven updates and wheel alignment
+    MotorValues<uint16_t> wheelTimestamps;
+    MotorValues<int> wheelIntervals;
+    MotorValues<float> integratedDegrees;
+    WheelHistory leftHistory;
+    WheelHistory rightHistory;
+
+    /// Pose and motion
+    Position position;
+    Distance distance;
+    Velocity velocity;
+    PoseCovariance covariance;
+
+    /// Settling
+    int stablizationAmount;
+    bool hasSettled;
+    std::array<float, SETTLE_WINDOW> leftSettleWindow;
+    std::array<float, SETTLE_WINDOW> rightSettleWindow;
+    int settleSamples;
+
+    /// Timing
+    uint16_t timestamp;
+    int deltaTime;
+    int previousDeltaTime;
+    int64_t poseClock;
+    uint16_t poseTimestamp;
+
+    /// Frame validation
+    ValidationCounters validationCounters;
+    int consecutiveRejects;
+    float rejectedSeconds;
+    bool forwardRatesKnown;
+    float leftForwardRate;
+    float rightForwardRate;
+
+    /// Gyro integration
+    bool gyroStarted;
+    float gyroAngle;
+    float gyroTime;
+    float gyroBias;
+    float lastGyroRate;
+    uint16_t gyroTimestamp;
+};
+
 class OdometryProcessor
 {
   public:
@@ -78,15 +390,99 @@ class OdometryProcessor
      * @param leftIncrease If the left motor increases in values as the system moves forward (bool)
      */
     OdometryProcessor(float wheelCircumference, float wheelBase, float gearRatio,
-                      float rolloverThreshold, bool rightIncrease = true, bool leftIncrease = true);
+                      float rolloverThreshold, bool rightIncrease = true,
+                      bool leftIncrease = true) noexcept;
+
+    /**
+     * @brief Construct a new Odometry Processor object with drive wheels that differ in size or
+     * gearing
+     *
+     * @param leftWheel Circumference (meters) and gear ratio of the left wheel
+     * @param rightWheel Circumference (meters) and gear ratio of the right wheel
+     * @param wheelBase The distance between the centerpoint of both drive wheels (meters)
+     * @param rolloverThreshold The number of degrees traveled in a single frame by the encoder to
+     * trigger a rollover event (int)
+     * @param rightIncrease If the right motor increases in values as the system moves forward
+     * (bool)
+     * @param leftIncrease If the left motor increases in values as the system moves forward (bool)
+     */
+    OdometryProcessor(WheelGeometry leftWheel, WheelGeometry rightWheel, float wheelBase,
+                      float rolloverThreshold, bool rightIncrease = true,
+                      bool leftIncrease = true) noexcept;
+
+    /**
+     * @brief Replace the drive geometry without resetting the pose, only safe to call from the
+     * thread processing frames
+     *
+     * @param geometry New wheel sizes, gearing and wheel base
+     */
+    void setGeometry(const DriveGeometry& geometry);
+
+    /**
+     * @brief Get the Geometry object
+     *
+     * @return DriveGeometry currently used for processing frames
+     */
+    DriveGeometry getGeometry() const noexcept
+    {
+        return {this->leftWheel, this->rightWheel, this->wheelBase};
+    }
+
+    /**
+     * @brief Pick up geometry published to a mailbox from any thread at the start of each frame
+     *
+     * @param mailbox Mailbox to check, must outlive the processor. nullptr to stop checking.
+     *
+     * @note Checking costs a single atomic load per frame when nothing new has been published
+     */
+    void attachGeometryMailbox(GeometryMailbox* mailbox);
 
     /**
      * @brief Update with the latest encoder readings
      *
      * @param value Encoder angle reading
+     *
+     * @note A wheel that is not updated before the next processData call is treated as not having
+     * moved that frame. Updating a wheel more then once before processData measures from the
+     * reading used in the last processed frame.
      */
     void updateCurrentValue(Motor motor, float value);
 
+    /**
+     * @brief Update with the latest encoder reading of a wheel and the time it was sampled
+     *
+     * @param motor Which motor the reading came from
+     * @param value Encoder angle reading
+     * @param timestamp Timestamp of the reading from the edge device (ms)
+     */
+    void updateCurrentValue(Motor motor, float value, uint16_t timestamp);
+
+    /**
+     * @brief Select how the wheel readings are aligned before being integrated
+     *
+     * @param mode NONE to integrate readings as they come in, LINEAR or CUBIC to interpolate both
+     * wheels to the older of their latest timestamps
+     *
+     * @note When aligning, readings must be given with their timestamps and the delta time comes
+     * from the aligned instants instead of updateTimestamp
+     */
+    void setAlignmentMode(AlignmentMode mode);
+
+    /**
+     * @brief Process a single wheel reading as soon as it arrives (event driven mode)
+     *
+     * The other wheel is extrapolated up to the timestamp at its last known rate so the pose is
+     * updated on every reading. When the other wheel reports, any error in that extrapolation is
+     * corrected by its real reading.
+     *
+     * @param motor Which motor the reading came from
+     * @param value Encoder angle reading
+     * @param timestamp Timestamp of the reading from the edge device (ms)
+     *
+     * @note Use either this or updateCurrentValue + processData, not both on the same processor
+     */
+    void processWheelUpdate(Motor motor, float value, uint16_t timestamp);
+
     /**
      * @brief Calculate the total distance the robot moved in the x axis
      *
@@ -105,12 +501,147 @@ class OdometryProcessor
      */
     void processData();
 
+    /**
+     * @brief Update both wheel readings and the timestamp from a frame, then process it
+     *
+     * @param frame Readings of both wheels
+     */
+    void processFrame(const EncoderFrame& frame);
+
+    /**
+     * @brief Process a run of frames in order, same as calling processFrame() on each
+     *
+     * @param frames Frames oldest first
+     * @param count Number of frames
+     */
+    void processBatch(const EncoderFrame* frames, size_t count);
+
+    /**
+     * @brief Select how the system decides it has stabilized, this restarts the settling process
+     *
+     * @param config Settle policy and its parameters
+     */
+    void setSettlePolicy(const SettleConfig& config);
+
+    /**
+     * @brief Check if the system has finished stabilizing
+     *
+     * @return true frames are being used to update odometry
+     * @return false frames are still being thrown out
+     */
+    bool isSettled() const noexcept { return this->hasSettled; }
+
     /**
      * @brief Get the Position object
      *
      * @return Position (x,y,theta) or robot in odom coordinate frame
      */
-    Position getPosition();
+    Position getPosition() const noexcept { return this->currentPosition; }
+
+    /**
+     * @brief Look up the pose at a given time, interpolating between recorded frames
+     *
+     * @param timestamp Timestamp in the same units as the edge device timestamps
+     * @param pose Set to the pose at that time
+     * @return true pose was found
+     * @return false the time is older then the last POSE_HISTORY_SIZE frames or newer then the
+     * latest frame
+     */
+    bool poseAt(uint16_t timestamp, Position& pose) const;
+
+    /**
+     * @brief Find how the system moved between two times
+     *
+     * @param from Starting timestamp
+     * @param to Ending timestamp
+     * @param transform Set to the pose at to expressed in the frame of the pose at from
+     * @return true both times were found in the pose history
+     * @return false either time is outside of the pose history
+     */
+    bool relativeTransform(uint16_t from, uint16_t to, Position& transform) const;
+
+    /**
+     * @brief Extrapolate the pose forward assuming the current velocity holds (constant twist)
+     *
+     * @param secondsAhead How far past the latest frame to predict (seconds)
+     * @return Position predicted pose, the latest pose if the velocity is not known
+     *
+     * @note Used to make up for latency between the last encoder frame and when the pose is used
+     */
+    Position predictPose(float secondsAhead) const;
+
+    /**
+     * @brief Turn on propagation of the pose covariance each frame
+     *
+     * @param leftNoise Variance added per meter traveled by the left wheel (m^2 / m)
+     * @param rightNoise Variance added per meter traveled by the right wheel (m^2 / m)
+     */
+    void enableCovariance(float leftNoise, float rightNoise);
+
+    /**
+     * @brief Get the Covariance object
+     *
+     * @return PoseCovariance of the pose, all zero if covariance is not enabled
+     */
+    PoseCovariance getCovariance() const noexcept { return this->covariance; }
+
+    /**
+     * @brief Turn on blending gyro heading changes with the wheel heading
+     *
+     * Each frame's heading change is a weighted average of the gyro and wheel increments. This is
+     * not a frequency split complementary filter, gyro drift is only held off by the bias estimate.
+     *
+     * @param gyroWeight Fraction of each frame's heading change taken from the gyro (0 - 1), the
+     * rest comes from the wheels
+     *
+     * @note Gyro readings before this call are discarded
+     */
+    void enableGyroFusion(float gyroWeight);
+
+    /**
+     * @brief Update with the latest gyro reading, can be called at any rate between frames
+     *
+     * @param zRate Turning rate about the z axis (rad/s)
+     * @param timestamp Timestamp of the reading in the same units as the encoder timestamps (ms)
+     *
+     * @note Readings are only integrated once fusion is enabled and the processor has settled.
+     * While both wheels are slower then GYRO_STILL_SPEED the gyro bias is estimated and removed.
+     */
+    void updateGyro(float zRate, uint16_t timestamp);
+
+    /**
+     * @brief Resolve rollovers from the frame delta time and wheel speed instead of the fixed
+     * rollover threshold
+     *
+     * The wrap (including multiple full turns) that lands closest to the travel predicted from the
+     * previous frame is used, as long as it is not faster then the max wheel speed. This allows
+     * polling the encoders slower then half a turn per frame.
+     *
+     * @param maxWheelSpeed Fastest a wheel can travel (m/s)
+     *
+     * @note Frames without a delta time fall back to the rollover threshold
+     */
+    void enableAdaptiveRollover(float maxWheelSpeed);
+
+    /**
+     * @brief Turn on checking each frame for encoder glitches and wheel slip
+     *
+     * @param config Limits to check against and what to do with frames that break them
+     *
+     * @note Checks use the delta time of the frame so timestamps must be provided. Event driven
+     * updates are not validated.
+     */
+    void enableFrameValidation(const ValidationConfig& config);
+
+    /**
+     * @brief Get the Validation Counters object
+     *
+     * @return ValidationCounters number of frames checked and the problems found
+     */
+    ValidationCounters getValidationCounters() const noexcept
+    {
+        return this->validationCounters;
+    }
 
     /**
      * @brief Get the Velocity object
@@ -120,35 +651,94 @@ class OdometryProcessor
      * @note For velocity calculations the library assumes the encoder processor (arduino, stm,
      * odrive) is offering some form of consistent time stamp. See README for more details on this.
      */
-    Velocity getVelocity();
+    Velocity getVelocity() const noexcept { return this->velocity; }
 
     /**
      * @brief Get the Distance object
      *
      * @return Distance (meters traveled in last frame and meters traveled since boot up)
      */
-    Distance getDistance();
+    Distance getDistance() const noexcept { return this->distance; }
+
+    /**
+     * @brief Get everything calculated as of the latest frame in a single copy
+     *
+     * @return OdometryState pose, velocity, distance and per motor totals
+     *
+     * @note Cheaper than calling several getters each control loop
+     */
+    OdometryState state() const noexcept
+    {
+        return {this->currentPosition,        this->velocity,
+                this->distance,               this->totalDegreesTraveled,
+                this->totalMetersTraveled,    this->degreesTraveledInFrame,
+                this->metersTraveledInFrame,  this->timestamp};
+    }
+
+    /**
+     * @brief Copy out the state needed to carry on integrating from the latest frame
+     *
+     * @return OdometryCheckpoint readings, pose and the in progress settle, timing, validation and
+     * gyro state
+     */
+    OdometryCheckpoint checkpoint() const noexcept;
+
+    /**
+     * @brief Carry on from a checkpoint taken from a processor configured like this one
+     *
+     * @param checkpoint State to continue from, the pose history starts again from its pose
+     */
+    void restore(const OdometryCheckpoint& checkpoint) noexcept;
 
     /**
      * @brief Get the Wheel Circumference object
      *
+     * @return float average circumference of the drive wheels in meters
+     */
+    float getWheelCircumference() const noexcept
+    {
+        return (this->leftWheel.circumference + this->rightWheel.circumference) / 2.0f;
+    }
+
+    /**
+     * @brief Get the Wheel Circumference of a single wheel
+     *
+     * @param motor Which motor's wheel
      * @return float wheel circumference in meters
      */
-    float getWheelCircumference();
+    float getWheelCircumference(Motor motor) const noexcept
+    {
+        return motor == Motor::LEFT ? this->leftWheel.circumference
+                                    : this->rightWheel.circumference;
+    }
 
     /**
      * @brief Get the Wheel Base object
      *
      * @return float distance between the two drive wheels in meters
      */
-    float getWheelBase();
+    float getWheelBase() const noexcept { return this->wheelBase; }
 
     /**
      * @brief Get the Gear Ratio object
      *
+     * @return float average wheel to encoder ratio of the drive wheels
+     */
+    float getGearRatio() const noexcept
+    {
+        return (this->leftWheel.gearRatio + this->rightWheel.gearRatio) / 2.0f;
+    }
+
+    /**
+     * @brief Get the Gear Ratio of a single wheel
+     *
+     * @param motor Which motor's wheel
      * @return float wheel to encoder ratio
      */
-    float getGearRatio();
+    float getGearRatio(Motor motor) const noexcept
+    {
+        return motor == Motor::LEFT ? this->leftWheel.gearRatio : this->rightWheel.gearRatio;
+    }
 
     /**
      * @brief Get the total degrees traveled of a single motor since powering up
@@ -156,7 +746,10 @@ class OdometryProcessor
      * @param motor Which motor you want the degrees from
      * @return float degrees traveled by motor
      */
-    float getTotalDegreesTraveled(Motor motor);
+    float getTotalDegreesTraveled(Motor motor) const noexcept
+    {
+        return this->totalDegreesTraveled[motor];
+    }
 
     /**
      * @brief Get the total meters traveled of a single motor since powering up
@@ -164,7 +757,10 @@ class OdometryProcessor
      * @param motor Which motor you want meters from
      * @return float total meters traveled by motor
      */
-    float getTotalMetersTraveled(Motor motor);
+    float getTotalMetersTraveled(Motor motor) const noexcept
+    {
+        return this->totalMetersTraveled[motor];
+    }
 
     /**
      * @brief Get the degrees traveled by a single motor in a single frame
@@ -172,7 +768,10 @@ class OdometryProcessor
      * @param motor
      * @return float degrees traveled by motor in frame
      */
-    float getDegreesTraveledInFrame(Motor motor);
+    float getDegreesTraveledInFrame(Motor motor) const noexcept
+    {
+        return this->degreesTraveledInFrame[motor];
+    }
 
     /**
      * @brief Get the meters traveled by a single motor in a single frame
@@ -180,7 +779,10 @@ class OdometryProcessor
      * @param motor
      * @return float meters traveled by a motor in a single frame
      */
-    float getMetersTraveledInFrame(Motor motor);
+    float getMetersTraveledInFrame(Motor motor) const noexcept
+    {
+        return this->metersTraveledInFrame[motor];
+    }
 
     /**
      * @brief Get the Current Reading object
@@ -188,7 +790,7 @@ class OdometryProcessor
      * @param motor
      * @return float
      */
-    float getCurrentReading(Motor motor);
+    float getCurrentReading(Motor motor) const noexcept { return this->currentReadings[motor]; }
 
     /**
      * @brief Get the Last Reading object
@@ -196,12 +798,14 @@ class OdometryProcessor
      * @param motor
      * @return float
      */
-    float getLastReading(Motor motor);
+    float getLastReading(Motor motor) const noexcept { return this->lastReadings[motor]; }
 
     /**
      * @brief Update the latest timestamp of received data
      *
      * @param timestamp
+     *
+     * @note Ignored when aligning, the delta time then comes from the aligned instants
      */
     void updateTimestamp(uint16_t timestamp);
 
@@ -210,7 +814,16 @@ class OdometryProcessor
      *
      * @return int delta of timestamp units since last frame
      */
-    int getDeltaTime();
+    int getDeltaTime() const noexcept { return this->deltaTime; }
+
+    /**
+     * @brief Wrap safe difference between two edge device timestamps
+     *
+     * @param now Later timestamp
+     * @param then Earlier timestamp
+     * @return int timestamp units from then to now (negative if then is actually later)
+     */
+    static int elapsedTime(uint16_t now, uint16_t then) noexcept;
 
   protected:
     /**
@@ -229,6 +842,16 @@ class OdometryProcessor
      */
     float calculateDeltaDegrees(float currentDegreeReading, float lastDegreeReading);
 
+    /**
+     * @brief Pick the most plausible number of rollovers from the frame delta time, the max wheel
+     * speed and the previous frame's travel
+     *
+     * @param motor Which drive motor the delta is from
+     * @param currentPreviousDelta Raw difference between the current and last reading
+     * @return float delta degree between last and current frame of the encoder
+     */
+    float calculateAdaptiveDeltaDegrees(Motor motor, float currentPreviousDelta);
+
     /**
      * @brief Calculate the meters a single motor traveled in single frame
      *
@@ -236,6 +859,67 @@ class OdometryProcessor
      */
     void calculateMetersMotorTraveledInFrame(Motor motor);
 
+    /**
+     * @brief Convert the degrees a single motor traveled in a frame to meters and add them to its
+     * total
+     *
+     * @param motor
+     */
+    void applyMetersTraveledInFrame(Motor motor);
+
+    /**
+     * @brief Recalculate the constants derived from the drive geometry
+     *
+     */
+    void updateDerivedConstants();
+
+    /**
+     * @brief Recalculate the frame rate if the delta time changed since the last frame
+     *
+     */
+    void updateFrameRate();
+
+    /**
+     * @brief Apply geometry from the attached mailbox if something new was published
+     *
+     */
+    void checkGeometryMailbox();
+
+    /**
+     * @brief Hold readings of wheels that did not report this frame and clear the sync trackers
+     *
+     */
+    void consumeSync();
+
+    /**
+     * @brief Update distance, heading and position from the meters traveled by each wheel in the
+     * frame
+     *
+     */
+    void integrateFrame();
+
+    /**
+     * @brief Record the total degrees of the wheels that reported this frame in their histories
+     *
+     */
+    void recordWheelSamples(bool leftUpdated, bool rightUpdated);
+
+    /**
+     * @brief Interpolate both wheels to a common instant and update the degrees traveled in frame
+     * from what has already been integrated
+     *
+     */
+    void alignWheels();
+
+    /**
+     * @brief Estimate the total degrees of a wheel at a given time from its history
+     *
+     * @param history Samples of the wheel
+     * @param timestamp Time to estimate at, clamped to the range of the history
+     * @return float total degrees traveled by the wheel at timestamp
+     */
+    float interpolateWheel(const WheelHistory& history, uint16_t timestamp);
+
     /**
      * @brief Calculate the distance traveled of system in single frame
      *
@@ -248,22 +932,52 @@ class OdometryProcessor
      */
     void calculateTheta();
 
+    /**
+     * @brief Check the degrees traveled in frame against the validation limits and reject or clamp
+     * them
+     *
+     */
+    void validateFrame();
+
+    /**
+     * @brief Propagate the pose covariance through the latest frame
+     *
+     * @note Must run after the position has been updated for the frame
+     */
+    void propagateCovariance();
+
     /**
      * @brief Evaluate if system has stabilized from first few readings at boot
      *
      * @return true system values are good to use
      * @return false system values are still stabilizing
+     *
+     * @note Only called until the system settles, after that processData skips it entirely
      */
     bool settled();
 
-    /// Circumference of robot wheels in meters
-    float wheelCircumference = 0.0;
+    /**
+     * @brief Record the latest frame deltas and check if they are stable enough to use
+     *
+     * @return true the variance of both wheels is under the configured threshold
+     * @return false not enough frames yet or the readings are still moving around
+     */
+    bool settledByVariance();
+
+    /// Circumference in meters and number of rotations encoder makes per 1 wheel rotation of each
+    /// drive wheel
+    WheelGeometry leftWheel = {0.0, 1.0};
+    WheelGeometry rightWheel = {0.0, 1.0};
+
+    /// Conversions derived from the geometry and timing, only recalculated when those change
+    DerivedConstants derived;
 
     /// Distance between wheel centers of robot in meters
     float wheelBase = 0.0;
 
-    /// Number of rotations encoder makes per 1 wheel rotation
-    float gearRatio = 1.0;
+    /// Mailbox new geometry is picked up from and the version of it last applied
+    GeometryMailbox* geometryMailbox = nullptr;
+    uint32_t appliedGeometryVersion = 0;
 
     /// Angle value that a delta change triggers a rollover
     /// Should be fine based on system max speed
@@ -277,6 +991,22 @@ class OdometryProcessor
     bool leftSync = false;
     bool rightSync = false;
 
+    /// Per wheel timestamp of the last reading and time between its last two readings, intervals
+    /// are only used in event driven mode
+    MotorValues<uint16_t> wheelTimestamps;
+    MotorValues<int> wheelIntervals;
+
+    /// Degrees of each wheel already applied to the pose, in event driven mode this includes the
+    /// extrapolated travel of the wheel that did not report
+    MotorValues<float> integratedDegrees;
+
+    /// How readings are aligned in time before integrating
+    AlignmentMode alignmentMode = AlignmentMode::NONE;
+
+    /// Recent timestamped samples of each wheel used for alignment
+    WheelHistory leftHistory;
+    WheelHistory rightHistory;
+
     /// Position of system
     Position currentPosition = {0, 0, 0};
     /// Distance system has traveled
@@ -284,17 +1014,28 @@ class OdometryProcessor
     /// Velocity of system at given frame
     Velocity velocity = {0, 0};
 
-    /// Mappings for each motors individual recorded values
-    std::map<Motor, float> currentReadings;
-    std::map<Motor, float> lastReadings;
-    std::map<Motor, float> totalDegreesTraveled;
-    std::map<Motor, float> metersTraveledInFrame;
-    std::map<Motor, float> totalMetersTraveled;
-    std::map<Motor, float> degreesTraveledInFrame;
+    /// Per motor readings and travel, fixed arrays indexed by Motor
+    MotorValues<float> currentReadings;
+    MotorValues<float> lastReadings;
+    MotorValues<float> totalDegreesTraveled;
+    MotorValues<float> metersTraveledInFrame;
+    MotorValues<float> totalMetersTraveled;
+    MotorValues<float> degreesTraveledInFrame;
 
     /// Number of readings to throw out before considering the system stabilized
     int stablizationAmount = SETTLE_READINGS;
 
+    /// How the system decides it has stabilized
+    SettleConfig settleConfig;
+
+    /// Set once the system has stabilized so the settle checks drop out of processData
+    bool hasSettled = false;
+
+    /// Recent frame deltas of each wheel used by the variance settle policy
+    std::array<float, SETTLE_WINDOW> leftSettleWindow = {};
+    std::array<float, SETTLE_WINDOW> rightSettleWindow = {};
+    int settleSamples = 0;
+
     /// Which direction positive change in encoder values should be expected
     bool rightIncrease;
     bool leftIncrease;
@@ -302,4 +1043,49 @@ class OdometryProcessor
     /// Timestamp of reading from edge device such as Arduino
     uint16_t timestamp = 0;
     int deltaTime = 0;
-};
\ No newline at end of file
+
+    /// Max wheel speed (m/s) used to resolve rollovers, 0 uses the rollover threshold instead
+    float adaptiveMaxWheelSpeed = 0.0;
+    /// Delta time of the previous integrated frame, used to scale its travel to this frame
+    int previousDeltaTime = 0;
+
+    /// Frame validation limits, results and the last accepted wheel speeds (m/s)
+    bool validationEnabled = false;
+    ValidationConfig validationConfig;
+    ValidationCounters validationCounters;
+    int consecutiveRejects = 0;
+    /// Time covered by the rejected frames since the last accepted one (s)
+    float rejectedSeconds = 0.0;
+    /// Set once a frame has been accepted, until then there is no speed to limit acceleration from
+    bool forwardRatesKnown = false;
+    float leftForwardRate = 0.0;
+    float rightForwardRate = 0.0;
+
+    /// Pose covariance and the per wheel noise driving it
+    bool covarianceEnabled = false;
+    float leftNoise = 0.0;
+    float rightNoise = 0.0;
+    PoseCovariance covariance = {};
+
+    /// Gyro heading change since the last frame and the state needed to integrate it
+    bool gyroFusionEnabled = false;
+    bool gyroStarted = false;
+    float gyroWeight = 0.0;
+    float gyroAngle = 0.0;
+    float gyroTime = 0.0;
+    float gyroBias = 0.0;
+    float lastGyroRate = 0.0;
+    uint16_t gyroTimestamp = 0;
+
+    /// Recent poses with the unwrapped time they were reached at
+    PoseHistory poseHistory;
+    int64_t poseClock = 0;
+    /// Edge device timestamp of the newest pose in the history
+    uint16_t poseTimestamp = 0;
+};
+
+// Processors own no heap memory, so they can be placed in caller memory, copied with memcpy and
+// dropped without running a destructor
+static_assert(std::is_trivially_copyable<OdometryProcessor>::value &&
+                  std::is_trivially_destructible<OdometryProcessor>::value,
+              "OdometryProcessor must stay a plain value");
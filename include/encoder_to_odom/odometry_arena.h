@@ -0,0 +1,115 @@
+/**
+ * @file odometry_arena.h
+ * @brief Bulk creation of processors in caller provided memory without heap allocations
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/**
+ * @brief Fixed number of processor slots carved out of a block of memory the caller owns
+ *
+ * For simulators that create and destroy many processors, for example one per robot per
+ * scenario. create() and release() are constant time and never touch the heap. Released slots
+ * are kept on a free list threaded through the slots themselves. Processors are trivially
+ * destructible, so reset() drops every processor at once. Not thread safe.
+ */
+class OdometryArena
+{
+  public:
+    /**
+     * @brief Get the memory needed to hold a number of processors, including room for alignment
+     *
+     * @param count Number of processors
+     * @return size_t bytes
+     */
+    static constexpr size_t bytesFor(size_t count) noexcept
+    {
+        return count * sizeof(OdometryProcessor) + alignof(OdometryProcessor) - 1;
+    }
+
+    /**
+     * @brief Construct a new Odometry Arena over memory that must outlive it
+     *
+     * @param memory Start of the memory, any alignment
+     * @param bytes Size of the memory
+     */
+    OdometryArena(void* memory, size_t bytes) noexcept;
+
+    OdometryArena(const OdometryArena&) = delete;
+    OdometryArena& operator=(const OdometryArena&) = delete;
+
+    /**
+     * @brief Construct a processor in a free slot
+     *
+     * @param args Arguments of any OdometryProcessor constructor
+     * @return OdometryProcessor* new processor, nullptr if every slot is in use
+     */
+    template <typename... Args> OdometryProcessor* create(Args&&... args) noexcept
+    {
+        void* slot = this->takeSlot();
+        if (slot == nullptr)
+        {
+            return nullptr;
+        }
+        return new (slot) OdometryProcessor(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Give a processor's slot back to the arena
+     *
+     * @param processor Processor from create(), nullptr is ignored
+     */
+    void release(OdometryProcessor* processor) noexcept;
+
+    /**
+     * @brief Drop every processor and make all slots free
+     *
+     */
+    void reset() noexcept;
+
+    /**
+     * @brief Get the number of slots
+     *
+     * @return size_t processors the memory holds
+     */
+    size_t getCapacity() const noexcept { return this->capacity; }
+
+    /**
+     * @brief Get the number of processors in use
+     *
+     * @return size_t processors created and not released
+     */
+    size_t getSize() const noexcept { return this->size; }
+
+  protected:
+    /**
+     * @brief Take a slot off the free list, or the next never used slot
+     *
+     * @return void* slot memory, nullptr if the arena is full
+     */
+    void* takeSlot() noexcept;
+
+    /**
+     * @brief Link in a released slot, stored in the slot it frees
+     *
+     */
+    struct FreeSlot
+    {
+        FreeSlot* next;
+    };
+
+    OdometryProcessor* slots = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
+    /// Slots past this were never used and are not on the free list
+    size_t used = 0;
+    FreeSlot* freeList = nullptr;
+};
@@ -0,0 +1,116 @@
+/**
+ * @file odometry_pool.h
+ * @brief Processing of many independent robot streams across a work stealing thread pool
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Frames of a stream processed before its remaining frames can be picked up by another thread
+constexpr size_t POOL_CHUNK_FRAMES = 4096;
+
+/**
+ * @brief Recorded frames of a single robot and the processor to run them through
+ *
+ */
+struct RobotStream
+{
+    OdometryProcessor* processor; /// Processor of the robot, only touched by one thread at a time
+    const EncoderFrame* frames;   /// Frames oldest first
+    size_t count;                 /// Number of frames
+};
+
+/**
+ * @brief Runs many robot streams in parallel while keeping each robot's frames in order
+ *
+ * Each stream is cut into chunks. A thread processes a chunk with processBatch() and then queues
+ * the rest of the stream on its own deque, so there is only ever one chunk of a robot in flight.
+ * Threads take work from the back of their own deque and steal from the front of others', so one
+ * very long log does not leave the other threads idle once the short ones finish.
+ */
+class OdometryPool
+{
+  public:
+    /**
+     * @brief Start the worker threads
+     *
+     * @param threadCount Threads processing streams, the calling thread included. 0 uses the
+     * number of hardware threads.
+     */
+    explicit OdometryPool(unsigned threadCount = 0);
+    ~OdometryPool();
+    OdometryPool(const OdometryPool&) = delete;
+    OdometryPool& operator=(const OdometryPool&) = delete;
+
+    /**
+     * @brief Process every stream to the end, returning once all are done
+     *
+     * The calling thread works through streams too. Only one thread can call this at a time.
+     *
+     * @param streams Streams to process, each processor must appear only once
+     * @param chunkFrames Frames processed at a time before the rest of a stream can be stolen
+     */
+    void process(const std::vector<RobotStream>& streams, size_t chunkFrames = POOL_CHUNK_FRAMES);
+
+    /**
+     * @brief Get the number of threads processing streams, the calling thread included
+     *
+     * @return unsigned thread count
+     */
+    unsigned getThreadCount() const noexcept { return static_cast<unsigned>(this->queues.size()); }
+
+  protected:
+    /**
+     * @brief Remaining frames of a stream
+     *
+     */
+    struct Task
+    {
+        size_t stream;
+        size_t offset;
+    };
+
+    /**
+     * @brief Tasks owned by a single thread, others steal from the front
+     *
+     */
+    struct TaskQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t worker);
+    void runTasks(size_t worker);
+    bool popTask(size_t worker, Task& task);
+    bool stealTask(size_t worker, Task& task);
+    void runTask(size_t worker, const Task& task);
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    /// Current job, written before its tasks are queued
+    const std::vector<RobotStream>* streams = nullptr;
+    size_t chunkFrames = POOL_CHUNK_FRAMES;
+    std::atomic<size_t> remainingStreams{0};
+
+    std::mutex jobMutex;
+    std::condition_variable jobStarted;
+    std::condition_variable jobFinished;
+    /// Idle threads wait here for a stream to be queued again or the job to finish
+    std::condition_variable taskAvailable;
+    uint64_t generation = 0;
+    uint64_t taskPushes = 0;
+    bool stopping = false;
+};
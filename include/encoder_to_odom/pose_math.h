@@ -0,0 +1,70 @@
+/**
+ * @file pose_math.h
+ * @brief Helpers for working with poses as rigid 2D transforms (SE(2))
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+/**
+ * @brief Wrap an angle into the range (-PI, PI]
+ *
+ * @param angle Angle in radians
+ * @return float equivalent angle in radians
+ */
+float normalizeAngle(float angle);
+
+/**
+ * @brief Apply the transform b in the frame of a
+ *
+ * @param a Starting pose
+ * @param b Pose relative to a
+ * @return Position b expressed in the frame a is expressed in
+ */
+Position composePose(const Position& a, const Position& b);
+
+/**
+ * @brief Find the transform that undoes a pose
+ *
+ * @param pose Pose to invert
+ * @return Position inverse such that composePose(pose, inverse) is the origin
+ */
+Position inversePose(const Position& pose);
+
+/**
+ * @brief Find the transform from one pose to another
+ *
+ * @param from Starting pose
+ * @param to Ending pose
+ * @return Position to expressed in the frame of from
+ */
+Position relativePose(const Position& from, const Position& to);
+
+/**
+ * @brief Convert a constant twist applied for unit time into the transform it produces
+ *
+ * @param twist Forward, sideways and turning motion (x, y, theta) over the time period
+ * @return Position transform reached by following the twist along an arc
+ */
+Position exponentialMap(const Position& twist);
+
+/**
+ * @brief Convert a transform into the constant twist that produces it, inverse of exponentialMap
+ *
+ * @param pose Transform to convert
+ * @return Position twist (x, y, theta) that moves from the origin to the pose in unit time
+ */
+Position logarithmMap(const Position& pose);
+
+/**
+ * @brief Interpolate between two poses along the constant twist connecting them
+ *
+ * @param a Pose at fraction 0
+ * @param b Pose at fraction 1
+ * @param fraction How far between the poses to go
+ * @return Position interpolated pose
+ */
+Position interpolatePose(const Position& a, const Position& b, float fraction);
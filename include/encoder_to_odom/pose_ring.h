@@ -0,0 +1,145 @@
+/**
+ * @file pose_ring.h
+ * @brief Publishes processed frames into a POSIX shared memory ring for same host readers
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/pose_stream.h"
+
+#include <atomic>
+
+/// Identifies a pose ring shared memory object, "ODRG" in little endian
+constexpr uint32_t POSE_RING_MAGIC = 0x4752444F;
+/// Number of 32 bit words in a PosePacket
+constexpr int POSE_RING_WORDS = sizeof(PosePacket) / sizeof(uint32_t);
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "pose ring needs lock free 64 bit atomics to be shared between processes");
+
+/**
+ * @brief Start of the shared memory object
+ *
+ */
+struct PoseRingHeader
+{
+    uint32_t magic;                  /// Always POSE_RING_MAGIC once the ring is ready
+    uint32_t capacity;               /// Number of slots following the header
+    std::atomic<uint64_t> published; /// Number of frames published so far
+};
+
+/**
+ * @brief A single frame in the ring, guarded by its own sequence lock
+ *
+ */
+struct PoseRingSlot
+{
+    /// 2 * frame + 1 while frame is being written, 2 * frame + 2 once it is complete
+    std::atomic<uint64_t> stamp;
+    std::atomic<uint32_t> words[POSE_RING_WORDS];
+};
+
+/**
+ * @brief Owns a shared memory ring and publishes a frame into it each time it is processed
+ *
+ * There must only be one writer per ring. The shared memory object is removed when the writer is
+ * destroyed; readers that already opened it keep their mapping.
+ */
+class PoseRingWriter
+{
+  public:
+    PoseRingWriter() = default;
+    ~PoseRingWriter();
+    PoseRingWriter(const PoseRingWriter&) = delete;
+    PoseRingWriter& operator=(const PoseRingWriter&) = delete;
+
+    /**
+     * @brief Create the shared memory object, replacing any stale one with the same name
+     *
+     * @param name Shared memory name, starting with a '/', for example "/robot_odom"
+     * @param capacity Number of frames kept for readers that fall behind
+     * @return true ring is ready for readers
+     * @return false ring already created, name invalid, capacity 0 or shared memory unavailable
+     */
+    bool create(const char* name, uint32_t capacity);
+
+    /**
+     * @brief Publish the latest frame, overwriting the oldest one if the ring is full
+     *
+     * @param state State of the processor after the frame
+     */
+    void publish(const OdometryState& state);
+
+  protected:
+    char name[256] = {};
+    PoseRingHeader* header = nullptr;
+    PoseRingSlot* slots = nullptr;
+    size_t size = 0;
+};
+
+/**
+ * @brief Reads frames from a ring published by another process without ever blocking the writer
+ *
+ */
+class PoseRingReader
+{
+  public:
+    PoseRingReader() = default;
+    ~PoseRingReader();
+    PoseRingReader(const PoseRingReader&) = delete;
+    PoseRingReader& operator=(const PoseRingReader&) = delete;
+
+    /**
+     * @brief Map an existing ring, starting at the next frame published
+     *
+     * @param name Shared memory name the writer created
+     * @return true ring is mapped
+     * @return false already open, ring does not exist or is not a pose ring
+     */
+    bool open(const char* name);
+
+    /**
+     * @brief Copy out the next unread frame
+     *
+     * Frames the writer overwrote before they were read, or is overwriting while they are read,
+     * are skipped and counted as missed. Never waits on the writer.
+     *
+     * @param packet Set to the next frame
+     * @return true a frame was read
+     * @return false no new frame has been published
+     */
+    bool next(PosePacket& packet);
+
+    /**
+     * @brief Copy out the newest complete frame, without moving the next() position
+     *
+     * @param packet Set to the newest frame
+     * @return true a frame was read
+     * @return false nothing has been published yet, or every slot was being overwritten
+     */
+    bool latest(PosePacket& packet) const;
+
+    /**
+     * @brief Get the number of frames that were overwritten before next() got to them
+     *
+     * @return uint64_t frames skipped since opened
+     */
+    uint64_t getMissedFrames() const noexcept { return this->missedFrames; }
+
+  protected:
+    /**
+     * @brief Read a single frame from its slot
+     *
+     * @return true the slot held the complete frame
+     * @return false the frame was not written yet or was overwritten during the read
+     */
+    bool readFrame(uint64_t frame, PosePacket& packet) const;
+
+    const PoseRingHeader* header = nullptr;
+    const PoseRingSlot* slots = nullptr;
+    size_t size = 0;
+    uint64_t cursor = 0;
+    uint64_t missedFrames = 0;
+};
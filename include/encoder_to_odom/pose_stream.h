@@ -0,0 +1,154 @@
+/**
+ * @file pose_stream.h
+ * @brief Streams processed frames to local subscribers as fixed layout binary packets
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+#include <sys/socket.h>
+
+/// Identifies a PosePacket, "OD" in little endian
+constexpr uint16_t POSE_PACKET_MAGIC = 0x444F;
+/// Most subscribers a PoseStreamServer can send to
+constexpr int MAX_STREAM_SUBSCRIBERS = 16;
+/// Frames queued before they are sent in a single batch
+constexpr int STREAM_BATCH_FRAMES = 8;
+
+/**
+ * @brief Wire format of a single processed frame, in host byte order
+ *
+ */
+struct PosePacket
+{
+    uint16_t magic;      /// Always POSE_PACKET_MAGIC
+    uint16_t timestamp;  /// Edge device timestamp of the frame
+    uint32_t sequence;   /// Frame number, increases by one per published frame
+    float x;             /// Meters along x in the odom frame
+    float y;             /// Meters along y in the odom frame
+    float theta;         /// Heading in radians
+    float linearX;       /// Forward velocity in meters per second
+    float angularZ;      /// Turning velocity in radians per second
+    float frameDistance; /// Meters moved in the frame
+    float totalDistance; /// Meters moved since boot
+};
+
+static_assert(sizeof(PosePacket) == 36, "PosePacket layout must not contain padding");
+
+/**
+ * @brief Build the packet for a processed frame
+ *
+ * @param state State of the processor after the frame
+ * @param sequence Frame number
+ * @return PosePacket packet ready to send
+ */
+PosePacket makePosePacket(const OdometryState& state, uint32_t sequence);
+
+/**
+ * @brief Check and copy out a received packet
+ *
+ * @param data Received bytes
+ * @param size Number of received bytes
+ * @param packet Set to the decoded packet
+ * @return true data holds a complete pose packet
+ * @return false data is the wrong size or not a pose packet
+ */
+bool decodePosePacket(const void* data, size_t size, PosePacket& packet);
+
+/**
+ * @brief Sends each processed frame to UDP and Unix domain datagram subscribers
+ *
+ * Frames are queued and sent every STREAM_BATCH_FRAMES frames with one sendmmsg call per socket.
+ * Each subscriber only gets every decimation-th frame. Sockets are non-blocking, so a subscriber
+ * that is not keeping up loses packets instead of stalling odometry.
+ */
+class PoseStreamServer
+{
+  public:
+    PoseStreamServer() = default;
+    ~PoseStreamServer();
+    PoseStreamServer(const PoseStreamServer&) = delete;
+    PoseStreamServer& operator=(const PoseStreamServer&) = delete;
+
+    /**
+     * @brief Send frames to a UDP port
+     *
+     * @param address IPv4 address of the subscriber, for example "127.0.0.1"
+     * @param port UDP port the subscriber is bound to
+     * @param decimation Send every decimation-th frame, 1 sends every frame
+     * @return true subscriber added
+     * @return false bad address or decimation, too many subscribers or socket could not open
+     */
+    bool addUdpSubscriber(const char* address, uint16_t port, uint32_t decimation = 1);
+
+    /**
+     * @brief Send frames to a Unix domain datagram socket
+     *
+     * @param path Path the subscriber socket is bound to
+     * @param decimation Send every decimation-th frame, 1 sends every frame
+     * @return true subscriber added
+     * @return false path too long, bad decimation, too many subscribers or socket could not open
+     */
+    bool addUnixSubscriber(const char* path, uint32_t decimation = 1);
+
+    /**
+     * @brief Queue the latest frame for every subscriber due one, sending once the batch is full
+     *
+     * @param state State of the processor after the frame
+     */
+    void publish(const OdometryState& state);
+
+    /**
+     * @brief Send everything queued now
+     *
+     * @return int number of packets sent
+     */
+    int flush();
+
+    /**
+     * @brief Get the number of packets the kernel would not accept
+     *
+     * @return uint32_t packets dropped since construction
+     */
+    uint32_t getDroppedPackets() const noexcept { return this->droppedPackets; }
+
+  protected:
+    /**
+     * @brief Where to send and how often
+     *
+     */
+    struct Subscriber
+    {
+        sockaddr_storage address;
+        socklen_t addressLength;
+        int socket;
+        uint32_t decimation;
+    };
+
+    bool addSubscriber(const sockaddr* address, socklen_t length, int family, uint32_t decimation);
+    int openSocket(int family);
+    int sendQueued(int socket);
+
+    Subscriber subscribers[MAX_STREAM_SUBSCRIBERS];
+    int subscriberCount = 0;
+    int udpSocket = -1;
+    int unixSocket = -1;
+
+    /// Frames waiting to be sent, shared by every message that references them
+    PosePacket packets[STREAM_BATCH_FRAMES];
+    int packetCount = 0;
+    /// Subscriber and packet index of each queued message
+    struct QueuedMessage
+    {
+        int subscriber;
+        int packet;
+    };
+    QueuedMessage queued[STREAM_BATCH_FRAMES * MAX_STREAM_SUBSCRIBERS];
+    int queuedCount = 0;
+
+    uint32_t sequence = 0;
+    uint32_t droppedPackets = 0;
+};
@@ -0,0 +1,49 @@
+/**
+ * @file trajectory.h
+ * @brief Parallel reconstruction of the trajectory of a single long recorded log
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+#include <cstddef>
+
+/// Fewest frames worth handing to a thread of its own
+constexpr size_t TRAJECTORY_MIN_BLOCK = 4096;
+
+/**
+ * @brief Robot the log was recorded on
+ *
+ */
+struct TrajectoryConfig
+{
+    DriveGeometry geometry;  /// Wheel sizes, gearing and wheel base
+    float rolloverThreshold; /// Largest reading change that is not a rollover
+    bool rightIncrease;      /// True if the right reading increases when driving forward
+    bool leftIncrease;       /// True if the left reading increases when driving forward
+    Position start;          /// Pose at the first frame
+};
+
+/**
+ * @brief Find the pose after every frame of a log using all cores
+ *
+ * Each frame moves the robot by a rigid transform that only depends on that frame and the one
+ * before it, and composing transforms is associative. So the log is split into blocks that are
+ * integrated in parallel from their own origin, the block end points are chained together, and
+ * every block is then moved onto its real starting pose in parallel.
+ *
+ * Gives the same poses as an OdometryProcessor with the same geometry that settled on the first
+ * frame, without the optional features (alignment, validation, gyro, adaptive rollover). Results
+ * differ from it only by float rounding.
+ *
+ * @param config Geometry the log was recorded with and the starting pose
+ * @param frames Frames oldest first, the first frame only gives the starting readings
+ * @param count Number of frames
+ * @param poses Filled with the pose after each frame, must hold count poses
+ * @param threadCount Threads to use, 0 uses the number of hardware threads
+ */
+void reconstructTrajectory(const TrajectoryConfig& config, const EncoderFrame* frames,
+                           size_t count, Position* poses, unsigned threadCount = 0);
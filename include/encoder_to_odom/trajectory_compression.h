@@ -0,0 +1,177 @@
+/**
+ * @file trajectory_compression.h
+ * @brief Streaming simplification and quantized encoding of stored pose output
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ */
+
+#pragma once
+#include "encoder_to_odom/odometry.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/// Largest encoded pose, four varints of at most 10 bytes each
+constexpr size_t POSE_DELTA_MAX_SIZE = 40;
+
+/**
+ * @brief Drops poses that a straight line between the kept ones already describes
+ *
+ * Error bounded piecewise linear simplification, one pose in at a time. Each kept pose (vertex)
+ * starts a segment, and for x, y and heading the simplifier keeps the range of slopes over time
+ * that pass within the allowed error of every pose since. A pose that empties any range ends the
+ * segment at the pose before it, on the middle slope, and starts the next one there. Every pose
+ * pushed is then within maxPositionError (and maxHeadingError) of interpolateVertices() between
+ * the two vertices around its time. Constant time per pose and no storage of past poses.
+ *
+ * A segment also ends before its heading changes by more than a quarter turn, so headings
+ * interpolate the short way around.
+ */
+class TrajectorySimplifier
+{
+  public:
+    /**
+     * @brief Construct a new Trajectory Simplifier
+     *
+     * @param maxPositionError Largest distance in meters from a pose to the simplified trajectory
+     * @param maxHeadingError Largest heading difference in radians
+     */
+    TrajectorySimplifier(float maxPositionError, float maxHeadingError);
+
+    /**
+     * @brief Add the next pose, for example getPosition() after each frame
+     *
+     * @param sample Pose and unwrapped time, poses not later than the last one are ignored
+     * @param vertex Set to the finished vertex when one is returned
+     * @return true a vertex was finished, the first pose is always one
+     * @return false pose absorbed into the current segment
+     */
+    bool push(const TimedPose& sample, TimedPose& vertex);
+
+    /**
+     * @brief End the current segment at the last pose, for example when the log is closed
+     *
+     * Pushing can carry on afterwards.
+     *
+     * @param vertex Set to the finished vertex when one is returned
+     * @return true a vertex was finished
+     * @return false every pose is already covered by the vertices returned
+     */
+    bool finish(TimedPose& vertex);
+
+  protected:
+    static constexpr int CHANNELS = 3;
+
+    /**
+     * @brief Set the slope ranges from the segment start to a pose
+     *
+     * @return true the ranges still overlap what was allowed before
+     */
+    bool narrow(int64_t time, const float* values, bool first);
+
+    /**
+     * @brief Close the segment at the last pose and start the next one there
+     *
+     */
+    TimedPose closeSegment();
+
+    float tolerance[CHANNELS];
+    bool started = false;
+    bool open = false;
+    int64_t anchorTime = 0;
+    float anchor[CHANNELS] = {}; /// Segment start, x, y and unwrapped heading
+    float low[CHANNELS] = {};    /// Smallest slope allowed per channel
+    float high[CHANNELS] = {};   /// Largest slope allowed per channel
+    int64_t lastTime = 0;
+    float last[CHANNELS] = {}; /// Last pose pushed, heading unwrapped
+};
+
+/**
+ * @brief Pose on the simplified trajectory between two vertices
+ *
+ * @param a Vertex at or before time
+ * @param b Vertex after a
+ * @param time Time between a and b
+ * @return Position straight line position and heading at time
+ */
+Position interpolateVertices(const TimedPose& a, const TimedPose& b, int64_t time);
+
+/**
+ * @brief Writes poses as quantized differences from the pose before
+ *
+ * x and y are rounded to a grid fine enough that a decoded position is within maxPositionError of
+ * the original, heading to steps of twice maxHeadingError. The grid indices are absolute, so
+ * rounding never accumulates over a long log. Each record is the change in time, x, y and heading
+ * index from the previous record as zigzag varints, a few bytes for a typical step.
+ */
+class PoseDeltaEncoder
+{
+  public:
+    /**
+     * @brief Construct a new Pose Delta Encoder
+     *
+     * @param maxPositionError Largest distance in meters between the original and decoded position
+     * @param maxHeadingError Largest heading difference in radians
+     */
+    PoseDeltaEncoder(float maxPositionError, float maxHeadingError);
+
+    /**
+     * @brief Encode the next pose
+     *
+     * @param pose Pose to write
+     * @param out Buffer of at least POSE_DELTA_MAX_SIZE bytes
+     * @return size_t bytes written
+     */
+    size_t encode(const TimedPose& pose, uint8_t* out);
+
+    /**
+     * @brief Start again as if nothing was encoded, for example at the start of a new file
+     *
+     */
+    void reset() noexcept;
+
+  protected:
+    double positionStep;
+    double headingStep;
+    int64_t last[4] = {}; /// Time and grid indices of the last pose
+};
+
+/**
+ * @brief Reads poses written by a PoseDeltaEncoder with the same errors
+ *
+ */
+class PoseDeltaDecoder
+{
+  public:
+    /**
+     * @brief Construct a new Pose Delta Decoder
+     *
+     * @param maxPositionError As given to the encoder
+     * @param maxHeadingError As given to the encoder
+     */
+    PoseDeltaDecoder(float maxPositionError, float maxHeadingError);
+
+    /**
+     * @brief Decode the next pose
+     *
+     * @param data Encoded bytes
+     * @param size Number of bytes available
+     * @param consumed Set to the bytes used by the pose
+     * @param pose Set to the decoded pose
+     * @return true pose decoded
+     * @return false data ends part way through a pose, nothing is consumed
+     */
+    bool decode(const uint8_t* data, size_t size, size_t& consumed, TimedPose& pose);
+
+    /**
+     * @brief Start again as if nothing was decoded
+     *
+     */
+    void reset() noexcept;
+
+  protected:
+    double positionStep;
+    double headingStep;
+    int64_t last[4] = {}; /// Time and grid indices of the last pose
+};
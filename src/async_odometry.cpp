@@ -0,0 +1,69 @@
+/**
+ * @file async_odometry.cpp
+ * @brief File to implement the coroutine executor and byte channel
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/async_odometry.h"
+
+#include <algorithm>
+
+void AsyncExecutor::post(std::coroutine_handle<> handle) { this->ready.push_back(handle); }
+
+size_t AsyncExecutor::runUntilIdle()
+{
+    size_t resumed = 0;
+    while (!this->ready.empty())
+    {
+        auto handle = this->ready.front();
+        this->ready.pop_front();
+        handle.resume();
+        resumed++;
+    }
+    return resumed;
+}
+
+size_t ByteChannel::write(const uint8_t* data, size_t size)
+{
+    size_t accepted = std::min(size, this->bytes.size() - this->count);
+    for (size_t index = 0; index < accepted; index++)
+    {
+        this->bytes[(this->head + this->count + index) % this->bytes.size()] = data[index];
+    }
+    this->count += accepted;
+    if (accepted > 0)
+    {
+        this->wake();
+    }
+    return accepted;
+}
+
+void ByteChannel::close()
+{
+    this->closed = true;
+    this->wake();
+}
+
+size_t ByteChannel::take(uint8_t* buffer, size_t size) noexcept
+{
+    size_t taken = std::min(size, this->count);
+    for (size_t index = 0; index < taken; index++)
+    {
+        buffer[index] = this->bytes[(this->head + index) % this->bytes.size()];
+    }
+    this->head = (this->head + taken) % this->bytes.size();
+    this->count -= taken;
+    return taken;
+}
+
+void ByteChannel::wake()
+{
+    // Resumed by the executor, not here, so the producer never runs the reader's code
+    if (this->reader)
+    {
+        this->executor.post(std::exchange(this->reader, nullptr));
+    }
+}
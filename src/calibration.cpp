@@ -0,0 +1,266 @@
+/**
+ * @file calibration.cpp
+ * @brief File to implement the wheel geometry least squares fit
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/calibration.h"
+#include "encoder_to_odom/pose_math.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+/// Parameter step size (meters) below which the solve is considered converged
+constexpr float CALIBRATION_TOLERANCE = 1e-7;
+
+namespace
+{
+/**
+ * @brief End point of a run and its derivatives with respect to (left circumference, right
+ * circumference, wheel base)
+ *
+ */
+struct RunEndPoint
+{
+    Position pose;
+    float jacobian[3][3]; /// Rows are x, y, theta
+};
+
+/**
+ * @brief Integrate a run with the given geometry the same way OdometryProcessor does
+ *
+ */
+RunEndPoint integrateRun(const CalibrationRun& run, float gearRatio, const double parameters[3])
+{
+    RunEndPoint result = {run.start, {}};
+    float& x = result.pose.x;
+    float& y = result.pose.y;
+    float& theta = result.pose.theta;
+    auto& jacobian = result.jacobian;
+
+    float leftCircumference = parameters[0];
+    float rightCircumference = parameters[1];
+    float wheelBase = parameters[2];
+
+    size_t frames = std::min(run.leftDegrees.size(), run.rightDegrees.size());
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        // Wheel rotations this frame
+        float leftRotations = run.leftDegrees[frame] / THREE_SIXTY / gearRatio;
+        float rightRotations = run.rightDegrees[frame] / THREE_SIXTY / gearRatio;
+        float leftDistance = leftRotations * leftCircumference;
+        float rightDistance = rightRotations * rightCircumference;
+
+        float ratio = (rightDistance - leftDistance) / wheelBase;
+        float angle = asinf(ratio);
+        float angleRate = 1.0f / sqrtf(1.0f - ratio * ratio);
+        float ratioDerivative[3] = {-leftRotations / wheelBase, rightRotations / wheelBase,
+                                    -ratio / wheelBase};
+
+        float frameDistance = (leftDistance + rightDistance) / 2.0f;
+        float distanceDerivative[3] = {leftRotations / 2.0f, rightRotations / 2.0f, 0.0f};
+
+        theta += angle;
+        float cosTheta = cosf(theta);
+        float sinTheta = sinf(theta);
+        x += frameDistance * cosTheta;
+        y += frameDistance * sinTheta;
+
+        for (int parameter = 0; parameter < 3; parameter++)
+        {
+            jacobian[2][parameter] += angleRate * ratioDerivative[parameter];
+            jacobian[0][parameter] += distanceDerivative[parameter] * cosTheta -
+                                      frameDistance * sinTheta * jacobian[2][parameter];
+            jacobian[1][parameter] += distanceDerivative[parameter] * sinTheta +
+                                      frameDistance * cosTheta * jacobian[2][parameter];
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Solve a 3x3 linear system in place with Gaussian elimination
+ *
+ * @return false if the system is singular
+ */
+bool solve3x3(double matrix[3][3], double vector[3], double solution[3])
+{
+    for (int pivot = 0; pivot < 3; pivot++)
+    {
+        int best = pivot;
+        for (int row = pivot + 1; row < 3; row++)
+        {
+            if (std::abs(matrix[row][pivot]) > std::abs(matrix[best][pivot]))
+            {
+                best = row;
+            }
+        }
+        if (std::abs(matrix[best][pivot]) < 1e-12)
+        {
+            return false;
+        }
+        std::swap(matrix[pivot], matrix[best]);
+        std::swap(vector[pivot], vector[best]);
+
+        for (int row = pivot + 1; row < 3; row++)
+        {
+            double factor = matrix[row][pivot] / matrix[pivot][pivot];
+            for (int col = pivot; col < 3; col++)
+            {
+                matrix[row][col] -= factor * matrix[pivot][col];
+            }
+            vector[row] -= factor * vector[pivot];
+        }
+    }
+
+    for (int row = 2; row >= 0; row--)
+    {
+        double sum = vector[row];
+        for (int col = row + 1; col < 3; col++)
+        {
+            sum -= matrix[row][col] * solution[col];
+        }
+        solution[row] = sum / matrix[row][row];
+    }
+    return true;
+}
+} // namespace
+
+CalibrationRun makeCalibrationRun(const EncoderFrame* frames, size_t count,
+                                  float rolloverThreshold, bool rightIncrease, bool leftIncrease,
+                                  const Position& start, const Position& end)
+{
+    CalibrationRun run = {{}, {}, start, end};
+    if (count == 0)
+    {
+        return run;
+    }
+    run.leftDegrees.reserve(count - 1);
+    run.rightDegrees.reserve(count - 1);
+
+    // Only the degrees are used, so any geometry will do
+    OdometryProcessor processor(1.0f, 1.0f, 1.0f, rolloverThreshold, rightIncrease, leftIncrease);
+    processor.setSettlePolicy({SettlePolicy::IMMEDIATE});
+    processor.processFrame(frames[0]);
+    float leftSign = leftIncrease ? 1.0f : -1.0f;
+    float rightSign = rightIncrease ? 1.0f : -1.0f;
+    for (size_t frame = 1; frame < count; frame++)
+    {
+        processor.processFrame(frames[frame]);
+        run.leftDegrees.push_back(leftSign * processor.getDegreesTraveledInFrame(Motor::LEFT));
+        run.rightDegrees.push_back(rightSign * processor.getDegreesTraveledInFrame(Motor::RIGHT));
+    }
+    return run;
+}
+
+WheelCalibration calibrateWheelGeometry(const CalibrationProblem& problem)
+{
+    double parameters[3] = {problem.wheelCircumference, problem.wheelCircumference,
+                            problem.wheelBase};
+    WheelCalibration calibration = {problem.wheelCircumference, problem.wheelCircumference,
+                                    problem.wheelBase, 0.0, 0};
+    if (problem.runs.empty())
+    {
+        return calibration;
+    }
+
+    for (int iteration = 0; iteration < CALIBRATION_ITERATIONS; iteration++)
+    {
+        // Normal equations of the end point errors of every run
+        double normal[3][3] = {};
+        double gradient[3] = {};
+        double squaredError = 0.0;
+        for (const auto& run : problem.runs)
+        {
+            RunEndPoint endPoint = integrateRun(run, problem.gearRatio, parameters);
+            float error[3] = {endPoint.pose.x - run.end.x, endPoint.pose.y - run.end.y,
+                              normalizeAngle(endPoint.pose.theta - run.end.theta)};
+
+            for (int row = 0; row < 3; row++)
+            {
+                squaredError += error[row] * error[row];
+                for (int parameter = 0; parameter < 3; parameter++)
+                {
+                    gradient[parameter] -= endPoint.jacobian[row][parameter] * error[row];
+                    for (int other = 0; other < 3; other++)
+                    {
+                        normal[parameter][other] +=
+                            endPoint.jacobian[row][parameter] * endPoint.jacobian[row][other];
+                    }
+                }
+            }
+        }
+        calibration.residual = std::sqrt(squaredError / (3 * problem.runs.size()));
+        calibration.iterations = iteration;
+
+        double step[3];
+        if (!solve3x3(normal, gradient, step))
+        {
+            break;
+        }
+        for (int parameter = 0; parameter < 3; parameter++)
+        {
+            parameters[parameter] += step[parameter];
+        }
+        calibration.leftCircumference = parameters[0];
+        calibration.rightCircumference = parameters[1];
+        calibration.wheelBase = parameters[2];
+        calibration.iterations = iteration + 1;
+
+        if (std::abs(step[0]) + std::abs(step[1]) + std::abs(step[2]) < CALIBRATION_TOLERANCE)
+        {
+            break;
+        }
+    }
+
+    // Report the error with the final geometry
+    double squaredError = 0.0;
+    for (const auto& run : problem.runs)
+    {
+        Position pose = integrateRun(run, problem.gearRatio, parameters).pose;
+        float dx = pose.x - run.end.x;
+        float dy = pose.y - run.end.y;
+        float dtheta = normalizeAngle(pose.theta - run.end.theta);
+        squaredError += dx * dx + dy * dy + dtheta * dtheta;
+    }
+    calibration.residual = std::sqrt(squaredError / (3 * problem.runs.size()));
+    return calibration;
+}
+
+std::vector<WheelCalibration> calibrateFleet(const std::vector<CalibrationProblem>& problems,
+                                             unsigned threadCount)
+{
+    std::vector<WheelCalibration> results(problems.size());
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min<unsigned>(threadCount, problems.size());
+
+    // Each worker takes the next unsolved problem until none are left
+    std::atomic<size_t> next{0};
+    auto worker = [&]()
+    {
+        for (size_t index = next++; index < problems.size(); index = next++)
+        {
+            results[index] = calibrateWheelGeometry(problems[index]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned thread = 1; thread < threadCount; thread++)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+    return results;
+}
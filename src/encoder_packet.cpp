@@ -0,0 +1,211 @@
+/**
+ * @file encoder_packet.cpp
+ * @brief File to implement encoding and decoding of serial encoder packets
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/encoder_packet.h"
+
+#include <cstring>
+
+/// Bytes of the payload covered by the CRC
+constexpr size_t CRC_COVERED_SIZE = ENCODER_PACKET_PAYLOAD_SIZE - 2;
+
+uint16_t crc16(const uint8_t* data, size_t size)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t index = 0; index < size; index++)
+    {
+        crc ^= static_cast<uint16_t>(data[index] << 8);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                 : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Write a float as its little endian bit pattern
+ *
+ */
+static void writeFloat(uint8_t* bytes, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int index = 0; index < 4; index++)
+    {
+        bytes[index] = static_cast<uint8_t>(bits >> (8 * index));
+    }
+}
+
+/**
+ * @brief Read a float from its little endian bit pattern
+ *
+ */
+static float readFloat(const uint8_t* bytes)
+{
+    uint32_t bits = 0;
+    for (int index = 0; index < 4; index++)
+    {
+        bits |= static_cast<uint32_t>(bytes[index]) << (8 * index);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+size_t encodeEncoderPacket(const EncoderFrame& frame, uint8_t* packet)
+{
+    uint8_t payload[ENCODER_PACKET_PAYLOAD_SIZE];
+    payload[0] = static_cast<uint8_t>(frame.timestamp);
+    payload[1] = static_cast<uint8_t>(frame.timestamp >> 8);
+    writeFloat(&payload[2], frame.left);
+    writeFloat(&payload[6], frame.right);
+    uint16_t crc = crc16(payload, CRC_COVERED_SIZE);
+    payload[10] = static_cast<uint8_t>(crc);
+    payload[11] = static_cast<uint8_t>(crc >> 8);
+
+    // COBS, each code byte is the distance to the next zero. The payload is shorter than 254
+    // bytes so a code never overflows.
+    size_t codeIndex = 0;
+    size_t write = 1;
+    uint8_t code = 1;
+    for (uint8_t byte : payload)
+    {
+        if (byte == 0)
+        {
+            packet[codeIndex] = code;
+            codeIndex = write++;
+            code = 1;
+        }
+        else
+        {
+            packet[write++] = byte;
+            code++;
+        }
+    }
+    packet[codeIndex] = code;
+    packet[write++] = 0;
+    return write;
+}
+
+bool EncoderPacketDecoder::push(uint8_t byte, EncoderFrame& frame)
+{
+    if (byte != 0)
+    {
+        if (this->discarding)
+        {
+            return false;
+        }
+        if (this->length == sizeof(this->buffer))
+        {
+            // Too long to be a packet, wait for the next delimiter to resync
+            this->counters.framingErrors++;
+            this->discarding = true;
+            this->length = 0;
+            return false;
+        }
+        this->buffer[this->length++] = byte;
+        return false;
+    }
+
+    if (this->discarding || this->length == 0)
+    {
+        // End of a thrown out packet or an idle delimiter
+        this->discarding = false;
+        return false;
+    }
+    bool valid = this->finishPacket(frame);
+    this->length = 0;
+    return valid;
+}
+
+size_t EncoderPacketDecoder::decode(const uint8_t* data, size_t size, EncoderFrame* frames,
+                                    size_t capacity, size_t& consumed)
+{
+    size_t count = 0;
+    consumed = 0;
+    while (consumed < size && count < capacity)
+    {
+        if (this->push(data[consumed++], frames[count]))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t EncoderPacketDecoder::decode(const uint8_t* data, size_t size,
+                                    OdometryProcessor& processor)
+{
+    size_t count = 0;
+    EncoderFrame frame;
+    for (size_t index = 0; index < size; index++)
+    {
+        if (this->push(data[index], frame))
+        {
+            processor.processFrame(frame);
+            count++;
+        }
+    }
+    return count;
+}
+
+void EncoderPacketDecoder::reset()
+{
+    this->length = 0;
+    this->discarding = false;
+}
+
+bool EncoderPacketDecoder::finishPacket(EncoderFrame& frame)
+{
+    uint8_t payload[ENCODER_PACKET_PAYLOAD_SIZE];
+    size_t read = 0;
+    size_t write = 0;
+    while (read < this->length)
+    {
+        uint8_t code = this->buffer[read++];
+        for (uint8_t index = 1; index < code; index++)
+        {
+            if (read == this->length || write == sizeof(payload))
+            {
+                this->counters.framingErrors++;
+                return false;
+            }
+            payload[write++] = this->buffer[read++];
+        }
+        // Every code but the last stands for a zero
+        if (read < this->length)
+        {
+            if (write == sizeof(payload))
+            {
+                this->counters.framingErrors++;
+                return false;
+            }
+            payload[write++] = 0;
+        }
+    }
+    if (write != sizeof(payload))
+    {
+        this->counters.framingErrors++;
+        return false;
+    }
+
+    uint16_t crc = static_cast<uint16_t>(payload[10] | (payload[11] << 8));
+    if (crc != crc16(payload, CRC_COVERED_SIZE))
+    {
+        this->counters.crcErrors++;
+        return false;
+    }
+
+    frame.timestamp = static_cast<uint16_t>(payload[0] | (payload[1] << 8));
+    frame.left = readFloat(&payload[2]);
+    frame.right = readFloat(&payload[6]);
+    this->counters.frames++;
+    return true;
+}
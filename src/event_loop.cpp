@@ -0,0 +1,228 @@
+/**
+ * @file event_loop.cpp
+ * @brief File to implement the epoll edge device reader and its watchdog
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/event_loop.h"
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+/// Most events handled per epoll_wait, one each for the link, watchdog and wake up
+constexpr int EVENT_COUNT = 3;
+/// Bytes read from the link at a time, enough for several packets
+constexpr size_t READ_SIZE = 256;
+
+OdometryEventLoop::OdometryEventLoop(OdometryProcessor& processor) : processor(processor) {}
+
+OdometryEventLoop::~OdometryEventLoop() { this->closeDescriptors(); }
+
+bool OdometryEventLoop::open(int descriptor, int staleTimeout)
+{
+    if (this->link >= 0)
+    {
+        // Already running on a link, the new descriptor is still ours to close
+        if (descriptor >= 0 && descriptor != this->link)
+        {
+            close(descriptor);
+        }
+        return false;
+    }
+    // Also releases everything created so far, so a retry starts from nothing
+    auto fail = [&]()
+    {
+        this->link = descriptor;
+        this->closeDescriptors();
+        return false;
+    };
+    if (descriptor < 0 || staleTimeout <= 0)
+    {
+        return fail();
+    }
+
+    this->epoll = epoll_create1(EPOLL_CLOEXEC);
+    this->watchdog = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    this->wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (this->epoll < 0 || this->watchdog < 0 || this->wake < 0)
+    {
+        return fail();
+    }
+
+    int flags = fcntl(descriptor, F_GETFL);
+    if (flags < 0 || fcntl(descriptor, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        return fail();
+    }
+
+    for (int watched : {descriptor, this->watchdog, this->wake})
+    {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = watched;
+        if (epoll_ctl(this->epoll, EPOLL_CTL_ADD, watched, &event) < 0)
+        {
+            return fail();
+        }
+    }
+
+    this->link = descriptor;
+    this->staleTimeout = staleTimeout;
+    this->armWatchdog();
+    return true;
+}
+
+void OdometryEventLoop::onFrame(std::function<void(const OdometryState&)> callback)
+{
+    this->frameCallback = std::move(callback);
+}
+
+void OdometryEventLoop::onStale(std::function<void(bool)> callback)
+{
+    this->staleCallback = std::move(callback);
+}
+
+int OdometryEventLoop::runOnce(int timeout)
+{
+    if (this->link < 0 || this->stopped)
+    {
+        return -1;
+    }
+
+    epoll_event events[EVENT_COUNT];
+    int count = epoll_wait(this->epoll, events, EVENT_COUNT, timeout);
+    if (count < 0)
+    {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    int frames = 0;
+    for (int index = 0; index < count; index++)
+    {
+        int descriptor = events[index].data.fd;
+        if (descriptor == this->link)
+        {
+            int processed = this->readLink();
+            if (processed < 0)
+            {
+                this->stopped = true;
+                return -1;
+            }
+            if (processed > 0)
+            {
+                this->armWatchdog();
+                if (this->stale)
+                {
+                    this->stale = false;
+                    if (this->staleCallback)
+                    {
+                        this->staleCallback(false);
+                    }
+                }
+            }
+            frames += processed;
+        }
+        else if (descriptor == this->watchdog)
+        {
+            uint64_t expirations;
+            if (read(this->watchdog, &expirations, sizeof(expirations)) > 0 && !this->stale)
+            {
+                this->stale = true;
+                if (this->staleCallback)
+                {
+                    this->staleCallback(true);
+                }
+            }
+        }
+        else if (descriptor == this->wake)
+        {
+            this->stopped = true;
+            return -1;
+        }
+    }
+    return frames;
+}
+
+void OdometryEventLoop::run()
+{
+    while (this->runOnce(-1) >= 0)
+    {
+    }
+}
+
+void OdometryEventLoop::stop()
+{
+    if (this->wake >= 0)
+    {
+        // Can only fail if the counter is already set, in which case run() is already stopping
+        uint64_t one = 1;
+        ssize_t written = write(this->wake, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+int OdometryEventLoop::readLink()
+{
+    uint8_t buffer[READ_SIZE];
+    int frames = 0;
+    while (true)
+    {
+        ssize_t size = read(this->link, buffer, sizeof(buffer));
+        if (size == 0)
+        {
+            // Writer closed the link, everything sent before that was already handled
+            return frames > 0 ? frames : -1;
+        }
+        if (size < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK ? frames : -1;
+        }
+
+        EncoderFrame frame;
+        for (ssize_t index = 0; index < size; index++)
+        {
+            if (!this->decoder.push(buffer[index], frame))
+            {
+                continue;
+            }
+            this->processor.processFrame(frame);
+            frames++;
+            if (this->frameCallback)
+            {
+                this->frameCallback(this->processor.state());
+            }
+        }
+    }
+}
+
+void OdometryEventLoop::armWatchdog()
+{
+    itimerspec countdown = {};
+    countdown.it_value.tv_sec = this->staleTimeout / 1000;
+    countdown.it_value.tv_nsec = (this->staleTimeout % 1000) * 1000000L;
+    timerfd_settime(this->watchdog, 0, &countdown, nullptr);
+}
+
+void OdometryEventLoop::closeDescriptors()
+{
+    for (int* descriptor : {&this->link, &this->epoll, &this->watchdog, &this->wake})
+    {
+        if (*descriptor >= 0)
+        {
+            close(*descriptor);
+            *descriptor = -1;
+        }
+    }
+}
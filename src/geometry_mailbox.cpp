@@ -0,0 +1,67 @@
+/**
+ * @file geometry_mailbox.cpp
+ * @brief File to implement the sequence locked geometry hand off
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/geometry_mailbox.h"
+
+#include <thread>
+
+void GeometryMailbox::publish(const DriveGeometry& geometry)
+{
+    // Claim the mailbox by moving the sequence from even to odd
+    uint32_t sequence = this->sequence.load(std::memory_order_relaxed);
+    while (sequence % 2 != 0 ||
+           !this->sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+        sequence = this->sequence.load(std::memory_order_relaxed);
+    }
+    // Keep the field stores below from becoming visible before the odd sequence
+    std::atomic_thread_fence(std::memory_order_release);
+
+    float values[FIELD_COUNT] = {geometry.leftWheel.circumference, geometry.leftWheel.gearRatio,
+                                 geometry.rightWheel.circumference, geometry.rightWheel.gearRatio,
+                                 geometry.wheelBase};
+    for (int field = 0; field < FIELD_COUNT; field++)
+    {
+        this->fields[field].store(values[field], std::memory_order_relaxed);
+    }
+
+    this->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+uint32_t GeometryMailbox::version() const
+{
+    return this->sequence.load(std::memory_order_acquire) / 2;
+}
+
+bool GeometryMailbox::tryRead(DriveGeometry& geometry, uint32_t& version) const
+{
+    uint32_t before = this->sequence.load(std::memory_order_acquire);
+    if (before == 0 || before % 2 != 0)
+    {
+        return false;
+    }
+
+    float values[FIELD_COUNT];
+    for (int field = 0; field < FIELD_COUNT; field++)
+    {
+        values[field] = this->fields[field].load(std::memory_order_relaxed);
+    }
+
+    // A publish that started while reading may have mixed old and new values
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (this->sequence.load(std::memory_order_relaxed) != before)
+    {
+        return false;
+    }
+
+    geometry = {{values[0], values[1]}, {values[2], values[3]}, values[4]};
+    version = before / 2;
+    return true;
+}
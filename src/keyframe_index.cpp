@@ -0,0 +1,313 @@
+/**
+ * @file keyframe_index.cpp
+ * @brief File to implement keyframe snapshots and lookups over recorded logs
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/keyframe_index.h"
+#include "encoder_to_odom/pose_math.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <type_traits>
+
+/**
+ * @brief Reads or writes an index file one number at a time, so the layout of the file does not
+ * depend on struct layout or padding
+ *
+ */
+struct FieldStream
+{
+    FILE* file;
+    bool writing;
+    bool valid = true;
+
+    template <typename T> void field(T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "only plain numbers are stored");
+        if (this->valid)
+        {
+            this->valid = (this->writing ? std::fwrite(&value, sizeof(value), 1, this->file)
+                                         : std::fread(&value, sizeof(value), 1, this->file)) == 1;
+        }
+    }
+};
+
+template <typename T, size_t N> static void transfer(FieldStream& stream, std::array<T, N>& values)
+{
+    for (auto& value : values)
+    {
+        stream.field(value);
+    }
+}
+
+template <typename T> static void transfer(FieldStream& stream, MotorValues<T>& values)
+{
+    transfer(stream, values.values);
+}
+
+static void transfer(FieldStream& stream, WheelHistory& history)
+{
+    for (auto& sample : history.samples)
+    {
+        stream.field(sample.timestamp);
+        stream.field(sample.degrees);
+    }
+    stream.field(history.head);
+    stream.field(history.count);
+}
+
+static void transfer(FieldStream& stream, ValidationCounters& counters)
+{
+    stream.field(counters.framesChecked);
+    stream.field(counters.speedViolations);
+    stream.field(counters.accelerationViolations);
+    stream.field(counters.speedDifferenceViolations);
+    stream.field(counters.rejectedFrames);
+    stream.field(counters.clampedFrames);
+}
+
+static void transfer(FieldStream& stream, Keyframe& keyframe)
+{
+    stream.field(keyframe.frame);
+    stream.field(keyframe.time);
+
+    OdometryCheckpoint& state = keyframe.checkpoint;
+    transfer(stream, state.currentReadings);
+    transfer(stream, state.lastReadings);
+    transfer(stream, state.totalDegreesTraveled);
+    transfer(stream, state.degreesTraveledInFrame);
+    transfer(stream, state.totalMetersTraveled);
+    transfer(stream, state.metersTraveledInFrame);
+    stream.field(state.previousLeftDegree);
+    stream.field(state.previousRightDegree);
+    stream.field(state.leftSync);
+    stream.field(state.rightSync);
+
+    transfer(stream, state.wheelTimestamps);
+    transfer(stream, state.wheelIntervals);
+    transfer(stream, state.integratedDegrees);
+    transfer(stream, state.leftHistory);
+    transfer(stream, state.rightHistory);
+
+    stream.field(state.position.x);
+    stream.field(state.position.y);
+    stream.field(state.position.theta);
+    stream.field(state.distance.frameDistance);
+    stream.field(state.distance.totalDistance);
+    stream.field(state.velocity.linearX);
+    stream.field(state.velocity.angularZ);
+    transfer(stream, state.covariance.values);
+
+    stream.field(state.stablizationAmount);
+    stream.field(state.hasSettled);
+    transfer(stream, state.leftSettleWindow);
+    transfer(stream, state.rightSettleWindow);
+    stream.field(state.settleSamples);
+
+    stream.field(state.timestamp);
+    stream.field(state.deltaTime);
+    stream.field(state.previousDeltaTime);
+    stream.field(state.poseClock);
+    stream.field(state.poseTimestamp);
+
+    transfer(stream, state.validationCounters);
+    stream.field(state.consecutiveRejects);
+    stream.field(state.rejectedSeconds);
+    stream.field(state.forwardRatesKnown);
+    stream.field(state.leftForwardRate);
+    stream.field(state.rightForwardRate);
+
+    stream.field(state.gyroStarted);
+    stream.field(state.gyroAngle);
+    stream.field(state.gyroTime);
+    stream.field(state.gyroBias);
+    stream.field(state.lastGyroRate);
+    stream.field(state.gyroTimestamp);
+}
+
+bool KeyframeIndex::build(const OdometryProcessor& initial, const EncoderFrame* frames,
+                          size_t count, size_t interval)
+{
+    if (interval == 0)
+    {
+        return false;
+    }
+
+    this->setInitial(initial);
+    this->keyframes.clear();
+    this->frameCount = count;
+    this->duration = 0;
+
+    OdometryProcessor processor = this->initial;
+    int64_t time = 0;
+    for (size_t frame = 0; frame < count; frame++)
+    {
+        if (frame > 0)
+        {
+            time += OdometryProcessor::elapsedTime(frames[frame].timestamp,
+                                                   frames[frame - 1].timestamp);
+        }
+        if (frame % interval == 0)
+        {
+            this->keyframes.push_back({frame, time, processor.checkpoint()});
+        }
+        processor.processFrame(frames[frame]);
+    }
+    this->duration = time;
+    return true;
+}
+
+bool KeyframeIndex::stateAt(const EncoderFrame* frames, size_t count, int64_t time,
+                            OdometryProcessor& processor) const
+{
+    const Keyframe* keyframe = this->findKeyframe(time);
+    if (count != this->frameCount || keyframe == nullptr)
+    {
+        return false;
+    }
+    int64_t frameTime;
+    this->replay(*keyframe, frames, time, processor, frameTime);
+    return true;
+}
+
+bool KeyframeIndex::poseAt(const EncoderFrame* frames, size_t count, int64_t time,
+                           Position& pose) const
+{
+    const Keyframe* keyframe = this->findKeyframe(time);
+    if (count != this->frameCount || keyframe == nullptr || time > this->duration)
+    {
+        return false;
+    }
+
+    OdometryProcessor processor = this->initial;
+    int64_t frameTime;
+    uint64_t frame = this->replay(*keyframe, frames, time, processor, frameTime);
+    pose = processor.getPosition();
+    if (frameTime == time)
+    {
+        return true;
+    }
+
+    // Between two frames, follow the arc to the next one
+    int64_t nextTime = frameTime + OdometryProcessor::elapsedTime(frames[frame + 1].timestamp,
+                                                                  frames[frame].timestamp);
+    processor.processFrame(frames[frame + 1]);
+    float fraction =
+        static_cast<float>(time - frameTime) / static_cast<float>(nextTime - frameTime);
+    pose = interpolatePose(pose, processor.getPosition(), fraction);
+    return true;
+}
+
+const Keyframe* KeyframeIndex::findKeyframe(int64_t time) const
+{
+    auto after = std::upper_bound(this->keyframes.begin(), this->keyframes.end(), time,
+                                  [](int64_t time, const Keyframe& keyframe)
+                                  { return time < keyframe.time; });
+    if (after == this->keyframes.begin())
+    {
+        return nullptr;
+    }
+    return &*(after - 1);
+}
+
+uint64_t KeyframeIndex::replay(const Keyframe& keyframe, const EncoderFrame* frames, int64_t time,
+                               OdometryProcessor& processor, int64_t& frameTime) const
+{
+    processor = this->initial;
+    processor.restore(keyframe.checkpoint);
+    uint64_t frame = keyframe.frame;
+    frameTime = keyframe.time;
+    processor.processFrame(frames[frame]);
+    while (frame + 1 < this->frameCount)
+    {
+        int64_t nextTime = frameTime + OdometryProcessor::elapsedTime(frames[frame + 1].timestamp,
+                                                                      frames[frame].timestamp);
+        if (nextTime > time)
+        {
+            break;
+        }
+        frame++;
+        frameTime = nextTime;
+        processor.processFrame(frames[frame]);
+    }
+    return frame;
+}
+
+bool KeyframeIndex::save(const char* path) const
+{
+    FILE* file = std::fopen(path, "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    FieldStream stream = {file, true};
+    uint32_t magic = KEYFRAME_INDEX_MAGIC;
+    uint32_t version = KEYFRAME_INDEX_VERSION;
+    uint64_t frameCount = this->frameCount;
+    uint64_t keyframeCount = this->keyframes.size();
+    int64_t duration = this->duration;
+    stream.field(magic);
+    stream.field(version);
+    stream.field(frameCount);
+    stream.field(keyframeCount);
+    stream.field(duration);
+    for (Keyframe keyframe : this->keyframes)
+    {
+        transfer(stream, keyframe);
+    }
+    return std::fclose(file) == 0 && stream.valid;
+}
+
+bool KeyframeIndex::load(const char* path, const OdometryProcessor& initial)
+{
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    FieldStream stream = {file, false};
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t frameCount = 0;
+    uint64_t keyframeCount = 0;
+    int64_t duration = 0;
+    stream.field(magic);
+    stream.field(version);
+    stream.field(frameCount);
+    stream.field(keyframeCount);
+    stream.field(duration);
+    bool valid = stream.valid && magic == KEYFRAME_INDEX_MAGIC && version == KEYFRAME_INDEX_VERSION;
+
+    std::vector<Keyframe> keyframes;
+    Keyframe keyframe = {};
+    for (uint64_t index = 0; valid && index < keyframeCount; index++)
+    {
+        transfer(stream, keyframe);
+        valid = stream.valid;
+        keyframes.push_back(keyframe);
+    }
+    std::fclose(file);
+    if (!valid)
+    {
+        return false;
+    }
+
+    this->setInitial(initial);
+    this->keyframes = std::move(keyframes);
+    this->frameCount = frameCount;
+    this->duration = duration;
+    return true;
+}
+
+void KeyframeIndex::setInitial(const OdometryProcessor& initial)
+{
+    this->initial = initial;
+    // The mailbox belongs to whoever configured the processor, lookups never follow it
+    this->initial.attachGeometryMailbox(nullptr);
+}
@@ -8,44 +8,501 @@
  */
 
 #include "encoder_to_odom/odometry.h"
+#include "encoder_to_odom/geometry_mailbox.h"
+#include "encoder_to_odom/pose_math.h"
+
+#include <algorithm>
+#include <cmath>
 
 OdometryProcessor::OdometryProcessor(float wheelCircumference, float wheelBase, float gearRatio,
-                                     float rolloverThreshold, bool rightIncrease, bool leftIncrease)
-    : wheelCircumference(wheelCircumference), wheelBase(wheelBase), gearRatio(gearRatio),
+                                     float rolloverThreshold, bool rightIncrease,
+                                     bool leftIncrease) noexcept
+    : OdometryProcessor({wheelCircumference, gearRatio}, {wheelCircumference, gearRatio}, wheelBase,
+                        rolloverThreshold, rightIncrease, leftIncrease)
+{
+}
+
+OdometryProcessor::OdometryProcessor(WheelGeometry leftWheel, WheelGeometry rightWheel,
+                                     float wheelBase, float rolloverThreshold, bool rightIncrease,
+                                     bool leftIncrease) noexcept
+    : leftWheel(leftWheel), rightWheel(rightWheel), wheelBase(wheelBase),
       rolloverThreshold(rolloverThreshold), rightIncrease(rightIncrease), leftIncrease(leftIncrease)
 {
     // Initialize the motor readings
     this->currentReadings[Motor::LEFT] = 0.0;
     this->currentReadings[Motor::RIGHT] = 0.0;
+
+    this->updateDerivedConstants();
+}
+
+void OdometryProcessor::updateDerivedConstants()
+{
+    // Fold each wheel's gearing, size and direction into a single conversion, motors where forward
+    // does not increase the readings get a negative conversion
+    float leftSign = this->leftIncrease ? 1.0f : -1.0f;
+    float rightSign = this->rightIncrease ? 1.0f : -1.0f;
+    this->derived.metersPerDegree[Motor::LEFT] =
+        leftSign * this->leftWheel.circumference / (THREE_SIXTY * this->leftWheel.gearRatio);
+    this->derived.metersPerDegree[Motor::RIGHT] =
+        rightSign * this->rightWheel.circumference / (THREE_SIXTY * this->rightWheel.gearRatio);
+    this->derived.inverseWheelBase = 1.0f / this->wheelBase;
+}
+
+OdometryCheckpoint OdometryProcessor::checkpoint() const noexcept
+{
+    return {this->currentReadings,
+            this->lastReadings,
+            this->totalDegreesTraveled,
+            this->degreesTraveledInFrame,
+            this->totalMetersTraveled,
+            this->metersTraveledInFrame,
+            this->previousLeftDegree,
+            this->previousRightDegree,
+            this->leftSync,
+            this->rightSync,
+            this->wheelTimestamps,
+            this->wheelIntervals,
+            this->integratedDegrees,
+            this->leftHistory,
+            this->rightHistory,
+            this->currentPosition,
+            this->distance,
+            this->velocity,
+            this->covariance,
+            this->stablizationAmount,
+            this->hasSettled,
+            this->leftSettleWindow,
+            this->rightSettleWindow,
+            this->settleSamples,
+            this->timestamp,
+            this->deltaTime,
+            this->previousDeltaTime,
+            this->poseClock,
+            this->poseTimestamp,
+            this->validationCounters,
+            this->consecutiveRejects,
+            this->rejectedSeconds,
+            this->forwardRatesKnown,
+            this->leftForwardRate,
+            this->rightForwardRate,
+            this->gyroStarted,
+            this->gyroAngle,
+            this->gyroTime,
+            this->gyroBias,
+            this->lastGyroRate,
+            this->gyroTimestamp};
+}
+
+void OdometryProcessor::restore(const OdometryCheckpoint& checkpoint) noexcept
+{
+    this->currentReadings = checkpoint.currentReadings;
+    this->lastReadings = checkpoint.lastReadings;
+    this->totalDegreesTraveled = checkpoint.totalDegreesTraveled;
+    this->degreesTraveledInFrame = checkpoint.degreesTraveledInFrame;
+    this->totalMetersTraveled = checkpoint.totalMetersTraveled;
+    this->metersTraveledInFrame = checkpoint.metersTraveledInFrame;
+    this->previousLeftDegree = checkpoint.previousLeftDegree;
+    this->previousRightDegree = checkpoint.previousRightDegree;
+    this->leftSync = checkpoint.leftSync;
+    this->rightSync = checkpoint.rightSync;
+    this->wheelTimestamps = checkpoint.wheelTimestamps;
+    this->wheelIntervals = checkpoint.wheelIntervals;
+    this->integratedDegrees = checkpoint.integratedDegrees;
+    this->leftHistory = checkpoint.leftHistory;
+    this->rightHistory = checkpoint.rightHistory;
+    this->currentPosition = checkpoint.position;
+    this->distance = checkpoint.distance;
+    this->velocity = checkpoint.velocity;
+    this->covariance = checkpoint.covariance;
+    this->stablizationAmount = checkpoint.stablizationAmount;
+    this->hasSettled = checkpoint.hasSettled;
+    this->leftSettleWindow = checkpoint.leftSettleWindow;
+    this->rightSettleWindow = checkpoint.rightSettleWindow;
+    this->settleSamples = checkpoint.settleSamples;
+    this->timestamp = checkpoint.timestamp;
+    this->deltaTime = checkpoint.deltaTime;
+    this->previousDeltaTime = checkpoint.previousDeltaTime;
+    this->poseClock = checkpoint.poseClock;
+    this->poseTimestamp = checkpoint.poseTimestamp;
+    this->validationCounters = checkpoint.validationCounters;
+    this->consecutiveRejects = checkpoint.consecutiveRejects;
+    this->rejectedSeconds = checkpoint.rejectedSeconds;
+    this->forwardRatesKnown = checkpoint.forwardRatesKnown;
+    this->leftForwardRate = checkpoint.leftForwardRate;
+    this->rightForwardRate = checkpoint.rightForwardRate;
+    this->gyroStarted = checkpoint.gyroStarted;
+    this->gyroAngle = checkpoint.gyroAngle;
+    this->gyroTime = checkpoint.gyroTime;
+    this->gyroBias = checkpoint.gyroBias;
+    this->lastGyroRate = checkpoint.lastGyroRate;
+    this->gyroTimestamp = checkpoint.gyroTimestamp;
+
+    // The next frame starts the history again from the restored pose
+    this->poseHistory.head = 0;
+    this->poseHistory.count = 0;
+}
+
+void OdometryProcessor::updateFrameRate()
+{
+    // Frames usually arrive at a fixed rate so this rarely needs the divide
+    if (this->deltaTime != this->derived.deltaTime)
+    {
+        this->derived.deltaTime = this->deltaTime;
+        this->derived.frameRate = 1000.0f / this->deltaTime;
+    }
+}
+
+void OdometryProcessor::setGeometry(const DriveGeometry& geometry)
+{
+    this->leftWheel = geometry.leftWheel;
+    this->rightWheel = geometry.rightWheel;
+    this->wheelBase = geometry.wheelBase;
+    this->updateDerivedConstants();
+}
+
+void OdometryProcessor::attachGeometryMailbox(GeometryMailbox* mailbox)
+{
+    this->geometryMailbox = mailbox;
+    this->appliedGeometryVersion = 0;
+}
+
+void OdometryProcessor::checkGeometryMailbox()
+{
+    if (this->geometryMailbox->version() == this->appliedGeometryVersion)
+    {
+        return;
+    }
+
+    // If a publish is in progress this is tried again next frame
+    DriveGeometry geometry;
+    if (this->geometryMailbox->tryRead(geometry, this->appliedGeometryVersion))
+    {
+        this->setGeometry(geometry);
+    }
 }
 // Setters
 void OdometryProcessor::updateCurrentValue(Motor motor, float value)
 {
-    // Update last reading with current reading in map
-    this->lastReadings[motor] = this->currentReadings[motor];
+    bool& sync = motor == Motor::LEFT ? this->leftSync : this->rightSync;
+
+    // Update last reading with current reading in map, only once per frame so the delta is always
+    // measured from the last processed reading
+    if (!sync)
+    {
+        this->lastReadings[motor] = this->currentReadings[motor];
+    }
 
     // Update current reading map with value from sensor
     this->currentReadings[motor] = value;
+    sync = true;
+}
+
+void OdometryProcessor::updateCurrentValue(Motor motor, float value, uint16_t timestamp)
+{
+    this->updateCurrentValue(motor, value);
+    this->wheelTimestamps[motor] = timestamp;
+}
+
+void OdometryProcessor::setAlignmentMode(AlignmentMode mode) { this->alignmentMode = mode; }
+
+void OdometryProcessor::processWheelUpdate(Motor motor, float value, uint16_t timestamp)
+{
+    if (this->geometryMailbox != nullptr)
+    {
+        this->checkGeometryMailbox();
+    }
+
+    this->lastReadings[motor] = this->currentReadings[motor];
+    this->currentReadings[motor] = value;
+
+    int interval = elapsedTime(timestamp, this->wheelTimestamps[motor]);
+    this->wheelTimestamps[motor] = timestamp;
+
+    if (!this->hasSettled && !this->settled())
+    {
+        this->timestamp = timestamp;
+        return;
+    }
+
+    this->calculateDegreesTraveledInFrame(motor);
+    this->wheelIntervals[motor] = interval;
+
+    Motor other = motor == Motor::LEFT ? Motor::RIGHT : Motor::LEFT;
+    float otherRate = other == Motor::LEFT ? this->previousLeftDegree : this->previousRightDegree;
+    int otherInterval = this->wheelIntervals[other];
+
+    // Extrapolate the other wheel up to now, never further then one of its own reporting intervals
+    float otherDegrees = this->totalDegreesTraveled[other];
+    if (otherInterval > 0)
+    {
+        int sinceOther = elapsedTime(timestamp, this->wheelTimestamps[other]);
+        sinceOther = std::max(0, std::min(sinceOther, otherInterval));
+        otherDegrees += otherRate * sinceOther / otherInterval;
+    }
+
+    this->degreesTraveledInFrame[motor] =
+        this->totalDegreesTraveled[motor] - this->integratedDegrees[motor];
+    this->degreesTraveledInFrame[other] = otherDegrees - this->integratedDegrees[other];
+    this->integratedDegrees[motor] = this->totalDegreesTraveled[motor];
+    this->integratedDegrees[other] = otherDegrees;
+
+    this->deltaTime = elapsedTime(timestamp, this->timestamp);
+    this->timestamp = timestamp;
+
+    this->applyMetersTraveledInFrame(Motor::LEFT);
+    this->applyMetersTraveledInFrame(Motor::RIGHT);
+    if (this->deltaTime > 0)
+    {
+        this->integrateFrame();
+        return;
+    }
+
+    // Both wheels reported in the same millisecond so there is no time to measure a rate over,
+    // move the pose but keep the velocity and frame rate of the last timed update
+    Velocity velocity = this->velocity;
+    int rateDeltaTime = this->derived.deltaTime;
+    float frameRate = this->derived.frameRate;
+    this->integrateFrame();
+    this->velocity = velocity;
+    this->derived.deltaTime = rateDeltaTime;
+    this->derived.frameRate = frameRate;
 }
 
 void OdometryProcessor::updateTimestamp(uint16_t timestamp)
 {
+    // When aligning, the frame time is the aligned instant set by alignWheels()
+    if (this->alignmentMode != AlignmentMode::NONE)
+    {
+        return;
+    }
+
     // Calculate delta time
-    this->deltaTime = timestamp - this->timestamp;
+    this->deltaTime = elapsedTime(timestamp, this->timestamp);
     // Update reading for next frame delta time
     this->timestamp = timestamp;
 }
 
+void OdometryProcessor::setSettlePolicy(const SettleConfig& config)
+{
+    this->settleConfig = config;
+    this->stablizationAmount = config.readings;
+    this->settleSamples = 0;
+    this->hasSettled = false;
+}
+
 bool OdometryProcessor::settled()
 {
-    if (this->stablizationAmount > 0)
+    switch (this->settleConfig.policy)
     {
-        this->stablizationAmount--;
-        return false;
+    case SettlePolicy::FIXED_COUNT:
+        if (this->stablizationAmount > 0)
+        {
+            this->stablizationAmount--;
+            return false;
+        }
+        break;
+    case SettlePolicy::VARIANCE_THRESHOLD:
+        if (!this->settledByVariance())
+        {
+            return false;
+        }
+        break;
+    case SettlePolicy::IMMEDIATE:
+        // The first frame only gives the starting readings, not a move from the constructor's 0.0
+        this->lastReadings = this->currentReadings;
+        break;
     }
+
+    // Heading is only integrated from here, so gyro turning up to now is not part of it
+    this->gyroStarted = false;
+    this->gyroAngle = 0.0;
+    this->gyroTime = 0.0;
+    this->hasSettled = true;
     return true;
 }
 
+bool OdometryProcessor::settledByVariance()
+{
+    // Store the newest deltas over the oldest ones
+    int slot = this->settleSamples % SETTLE_WINDOW;
+    this->leftSettleWindow[slot] = this->calculateDeltaDegrees(
+        this->getCurrentReading(Motor::LEFT), this->getLastReading(Motor::LEFT));
+    this->rightSettleWindow[slot] = this->calculateDeltaDegrees(
+        this->getCurrentReading(Motor::RIGHT), this->getLastReading(Motor::RIGHT));
+    this->settleSamples++;
+
+    if (this->settleSamples < SETTLE_WINDOW)
+    {
+        return false;
+    }
+
+    auto variance = [](const std::array<float, SETTLE_WINDOW>& window)
+    {
+        float mean = 0.0;
+        for (auto value : window)
+        {
+            mean += value;
+        }
+        mean /= SETTLE_WINDOW;
+
+        float sum = 0.0;
+        for (auto value : window)
+        {
+            sum += (value - mean) * (value - mean);
+        }
+        return sum / SETTLE_WINDOW;
+    };
+
+    return variance(this->leftSettleWindow) <= this->settleConfig.varianceThreshold &&
+           variance(this->rightSettleWindow) <= this->settleConfig.varianceThreshold;
+}
+
+void OdometryProcessor::consumeSync()
+{
+    // A wheel that did not report has not moved as far as we know
+    if (!this->leftSync)
+    {
+        this->lastReadings[Motor::LEFT] = this->currentReadings[Motor::LEFT];
+    }
+    if (!this->rightSync)
+    {
+        this->lastReadings[Motor::RIGHT] = this->currentReadings[Motor::RIGHT];
+    }
+    this->leftSync = false;
+    this->rightSync = false;
+}
+
+void WheelHistory::push(uint16_t timestamp, float degrees)
+{
+    this->samples[this->head] = {timestamp, degrees};
+    this->head = (this->head + 1) % WHEEL_HISTORY;
+    this->count = std::min(this->count + 1, WHEEL_HISTORY);
+}
+
+const WheelSample& WheelHistory::at(int index) const
+{
+    return this->samples[(this->head + WHEEL_HISTORY - this->count + index) % WHEEL_HISTORY];
+}
+
+void OdometryProcessor::recordWheelSamples(bool leftUpdated, bool rightUpdated)
+{
+    if (leftUpdated)
+    {
+        this->leftHistory.push(this->wheelTimestamps[Motor::LEFT],
+                               this->totalDegreesTraveled[Motor::LEFT]);
+    }
+    if (rightUpdated)
+    {
+        this->rightHistory.push(this->wheelTimestamps[Motor::RIGHT],
+                                this->totalDegreesTraveled[Motor::RIGHT]);
+    }
+}
+
+void OdometryProcessor::alignWheels()
+{
+    if (this->leftHistory.count == 0 || this->rightHistory.count == 0)
+    {
+        this->degreesTraveledInFrame[Motor::LEFT] = 0.0;
+        this->degreesTraveledInFrame[Motor::RIGHT] = 0.0;
+        return;
+    }
+
+    // Align to the older of the two newest samples so neither wheel has to be extrapolated
+    uint16_t leftNewest = this->leftHistory.at(this->leftHistory.count - 1).timestamp;
+    uint16_t rightNewest = this->rightHistory.at(this->rightHistory.count - 1).timestamp;
+    uint16_t alignedTime = elapsedTime(leftNewest, rightNewest) < 0 ? leftNewest : rightNewest;
+
+    float left = this->interpolateWheel(this->leftHistory, alignedTime);
+    float right = this->interpolateWheel(this->rightHistory, alignedTime);
+
+    this->degreesTraveledInFrame[Motor::LEFT] = left - this->integratedDegrees[Motor::LEFT];
+    this->degreesTraveledInFrame[Motor::RIGHT] = right - this->integratedDegrees[Motor::RIGHT];
+    this->integratedDegrees[Motor::LEFT] = left;
+    this->integratedDegrees[Motor::RIGHT] = right;
+
+    this->deltaTime = elapsedTime(alignedTime, this->timestamp);
+    this->timestamp = alignedTime;
+}
+
+float OdometryProcessor::interpolateWheel(const WheelHistory& history, uint16_t timestamp)
+{
+    // Times of each sample relative to the requested time, oldest first
+    int newest = history.count - 1;
+    int times[WHEEL_HISTORY];
+    for (int i = 0; i <= newest; i++)
+    {
+        times[i] = elapsedTime(history.at(i).timestamp, timestamp);
+    }
+
+    // No extrapolation past either end of the history
+    if (times[newest] <= 0)
+    {
+        return history.at(newest).degrees;
+    }
+    if (times[0] >= 0)
+    {
+        return history.at(0).degrees;
+    }
+
+    // The polynomial needs every sample at a different time, repeated timestamps fall back to
+    // straight lines between the samples
+    bool distinctTimes = true;
+    for (int i = 1; i <= newest; i++)
+    {
+        for (int j = 0; j < i; j++)
+        {
+            distinctTimes = distinctTimes && times[i] != times[j];
+        }
+    }
+
+    if (this->alignmentMode == AlignmentMode::CUBIC && history.count == WHEEL_HISTORY &&
+        distinctTimes)
+    {
+        // Lagrange polynomial through all samples evaluated at the requested time (0)
+        float result = 0.0;
+        for (int i = 0; i < WHEEL_HISTORY; i++)
+        {
+            float weight = 1.0;
+            for (int j = 0; j < WHEEL_HISTORY; j++)
+            {
+                if (j != i)
+                {
+                    weight *= static_cast<float>(-times[j]) / (times[i] - times[j]);
+                }
+            }
+            result += weight * history.at(i).degrees;
+        }
+        return result;
+    }
+
+    // Find the pair of samples around the requested time
+    int after = newest;
+    while (times[after - 1] > 0)
+    {
+        after--;
+    }
+    const WheelSample& before = history.at(after - 1);
+    float fraction = static_cast<float>(-times[after - 1]) / (times[after] - times[after - 1]);
+    return before.degrees + (history.at(after).degrees - before.degrees) * fraction;
+}
+
+void PoseHistory::push(int64_t time, const Position& pose)
+{
+    this->poses[this->head] = {time, pose};
+    this->head = (this->head + 1) % POSE_HISTORY_SIZE;
+    this->count = std::min(this->count + 1, POSE_HISTORY_SIZE);
+}
+
+const TimedPose& PoseHistory::at(int index) const
+{
+    return this->poses[(this->head + POSE_HISTORY_SIZE - this->count + index) % POSE_HISTORY_SIZE];
+}
+
+int OdometryProcessor::elapsedTime(uint16_t now, uint16_t then) noexcept
+{
+    return static_cast<int16_t>(static_cast<uint16_t>(now - then));
+}
+
 // Calculations
 float OdometryProcessor::calculateDeltaDegrees(float currentDegreeReading, float lastDegreeReading)
 {
@@ -65,6 +522,33 @@ float OdometryProcessor::calculateDeltaDegrees(float currentDegreeReading, float
     return currentPreviousDelta;
 }
 
+float OdometryProcessor::calculateAdaptiveDeltaDegrees(Motor motor, float currentPreviousDelta)
+{
+    float previousDegrees =
+        motor == Motor::LEFT ? this->previousLeftDegree : this->previousRightDegree;
+
+    // Expect the wheel to keep the speed it had last frame
+    float predicted = 0.0;
+    if (this->previousDeltaTime > 0)
+    {
+        predicted = previousDegrees * this->deltaTime / this->previousDeltaTime;
+    }
+
+    // Number of full turns that lands closest to the prediction
+    float delta = currentPreviousDelta +
+                  THREE_SIXTY * roundf((predicted - currentPreviousDelta) / THREE_SIXTY);
+
+    // Step back towards no rollover while faster then the wheel can go
+    float maxDegrees = this->adaptiveMaxWheelSpeed /
+                       fabsf(this->derived.metersPerDegree[motor]) *
+                       (this->deltaTime / 1000.0f);
+    while (fabsf(delta) > maxDegrees && fabsf(delta) > THREE_SIXTY / 2.0f)
+    {
+        delta -= copysignf(THREE_SIXTY, delta);
+    }
+    return delta;
+}
+
 void OdometryProcessor::calculateDegreesTraveledInFrame(Motor motor)
 {
 
@@ -73,36 +557,37 @@ void OdometryProcessor::calculateDegreesTraveledInFrame(Motor motor)
     auto lastReading = this->getLastReading(motor);
 
     // calculate the delta degrees
-    float deltaDegrees = calculateDeltaDegrees(currentReading, lastReading);
+    float deltaDegrees = this->adaptiveMaxWheelSpeed > 0.0f && this->deltaTime > 0
+                             ? calculateAdaptiveDeltaDegrees(motor, currentReading - lastReading)
+                             : calculateDeltaDegrees(currentReading, lastReading);
 
     // Update motors entry values
     this->totalDegreesTraveled[motor] += deltaDegrees;
     this->degreesTraveledInFrame[motor] = deltaDegrees;
+
+    if (motor == Motor::LEFT)
+    {
+        this->previousLeftDegree = deltaDegrees;
+    }
+    else
+    {
+        this->previousRightDegree = deltaDegrees;
+    }
 }
 
 void OdometryProcessor::calculateMetersMotorTraveledInFrame(Motor motor) // Per frame
 {
     this->calculateDegreesTraveledInFrame(motor);
+    this->applyMetersTraveledInFrame(motor);
+}
 
+void OdometryProcessor::applyMetersTraveledInFrame(Motor motor)
+{
     auto deltaDegrees = this->getDegreesTraveledInFrame(motor);
 
-    // Handle motors that forward is not increasing value changes
-    if (!this->leftIncrease && motor == Motor::LEFT)
-    {
-        deltaDegrees = -deltaDegrees;
-    }
-    if (!this->rightIncrease && motor == Motor::RIGHT)
-    {
-        deltaDegrees = -deltaDegrees;
-    }
-
-    // Find number of encoder rotations based on wheel rotations
-    float encoderRotations = deltaDegrees / THREE_SIXTY;
-    // Convert encoder rotations to wheel rotations
-    float rotations = encoderRotations / this->gearRatio;
-
-    // Convert wheel rotations to meters traveled in this frame
-    float metersTraveled = rotations * this->wheelCircumference;
+    // Convert encoder degrees to meters traveled in this frame, the wheel's gear ratio,
+    // circumference and direction are folded into the conversion
+    float metersTraveled = deltaDegrees * this->derived.metersPerDegree[motor];
 
     this->metersTraveledInFrame[motor] = metersTraveled;
     this->totalMetersTraveled[motor] += metersTraveled;
@@ -116,10 +601,7 @@ void OdometryProcessor::calculateFrameDistance()
 
     this->distance.frameDistance = (rightDistance + leftDistance) / 2.0;
 
-    std::cout << "DT (milli): " << this->getDeltaTime()
-              << " DT (sec): " << this->getDeltaTime() / 1000.0f << std::endl;
-
-    this->velocity.linearX = this->distance.frameDistance / (this->getDeltaTime() / 1000.0f);
+    this->velocity.linearX = this->distance.frameDistance * this->derived.frameRate;
 
     this->distance.totalDistance += this->distance.frameDistance;
 }
@@ -134,9 +616,27 @@ void OdometryProcessor::calculateTheta()
     // Delta between two motors traveled
     float difference = rightDistance - leftDistance;
 
-    float angle = asinf(difference / this->wheelBase); // Radians
+    float angle = asinf(difference * this->derived.inverseWheelBase); // Radians
+
+    // Without a gyro sample in this frame there is nothing to blend, keep the wheel heading
+    if (this->gyroFusionEnabled && this->gyroTime > 0.0f)
+    {
+        // Allow for encoder jitter when deciding the robot is standing still
+        float stillDistance = GYRO_STILL_SPEED * this->gyroTime;
+        if (fabsf(rightDistance) <= stillDistance && fabsf(leftDistance) <= stillDistance)
+        {
+            // Standing still, any gyro rate left is bias
+            this->gyroBias += GYRO_BIAS_GAIN * this->gyroAngle / this->gyroTime;
+        }
+        else
+        {
+            angle = this->gyroWeight * this->gyroAngle + (1.0f - this->gyroWeight) * angle;
+        }
+        this->gyroAngle = 0.0;
+        this->gyroTime = 0.0;
+    }
     // Radians / sec
-    this->velocity.angularZ = angle / (this->getDeltaTime() / 1000.0f);
+    this->velocity.angularZ = angle * this->derived.frameRate;
 
     this->currentPosition.theta += (angle);
     // Restrain theta to a single 180
@@ -162,51 +662,376 @@ void OdometryProcessor::calculateDistanceMovedY()
     this->currentPosition.y += distanceMoved;
 }
 
+void OdometryProcessor::processFrame(const EncoderFrame& frame)
+{
+    this->updateCurrentValue(Motor::LEFT, frame.left, frame.timestamp);
+    this->updateCurrentValue(Motor::RIGHT, frame.right, frame.timestamp);
+    this->updateTimestamp(frame.timestamp);
+    this->processData();
+}
+
+void OdometryProcessor::processBatch(const EncoderFrame* frames, size_t count)
+{
+    for (size_t index = 0; index < count; index++)
+    {
+        this->processFrame(frames[index]);
+    }
+}
+
 void OdometryProcessor::processData()
 {
+    // New geometry is only ever applied between frames
+    if (this->geometryMailbox != nullptr)
+    {
+        this->checkGeometryMailbox();
+    }
+
+    bool leftUpdated = this->leftSync;
+    bool rightUpdated = this->rightSync;
+    this->consumeSync();
+
+    // Once settled this is a single flag check per frame
+    if (!this->hasSettled && !this->settled())
+    {
+        if (this->alignmentMode != AlignmentMode::NONE)
+        {
+            // Give the histories a starting point so the first frame can be interpolated
+            this->recordWheelSamples(leftUpdated, rightUpdated);
+            this->alignWheels();
+        }
+        return;
+    }
+
+    this->calculateDegreesTraveledInFrame(Motor::LEFT);
+    this->calculateDegreesTraveledInFrame(Motor::RIGHT);
+
+    if (this->validationEnabled)
+    {
+        this->validateFrame();
+    }
+
+    if (this->alignmentMode != AlignmentMode::NONE)
+    {
+        this->recordWheelSamples(leftUpdated, rightUpdated);
+        this->alignWheels();
+    }
+
+    this->applyMetersTraveledInFrame(Motor::LEFT);
+    this->applyMetersTraveledInFrame(Motor::RIGHT);
+
+    this->integrateFrame();
+}
+
+void OdometryProcessor::integrateFrame()
+{
+    // Starting pose so the first frame can be interpolated
+    if (this->poseHistory.count == 0)
+    {
+        this->poseHistory.push(this->poseClock, this->currentPosition);
+    }
+
+    this->updateFrameRate();
+    this->calculateFrameDistance();
+    this->calculateTheta();
+
+    this->calculateDistanceMovedX();
+    this->calculateDistanceMovedY();
+
+    if (this->covarianceEnabled)
+    {
+        this->propagateCovariance();
+    }
+
+    this->poseClock += this->deltaTime;
+    this->previousDeltaTime = this->deltaTime;
+    this->poseTimestamp = this->timestamp;
+    this->poseHistory.push(this->poseClock, this->currentPosition);
+}
+
+bool OdometryProcessor::poseAt(uint16_t timestamp, Position& pose) const
+{
+    if (this->poseHistory.count == 0)
+    {
+        return false;
+    }
+
+    int newest = this->poseHistory.count - 1;
+    int64_t time = this->poseHistory.at(newest).time - elapsedTime(this->poseTimestamp, timestamp);
+
+    // Binary search for the first pose after the requested time
+    int low = 0;
+    int high = this->poseHistory.count;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (this->poseHistory.at(middle).time <= time)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low == 0)
+    {
+        return false;
+    }
+    const TimedPose& before = this->poseHistory.at(low - 1);
+    if (low == this->poseHistory.count)
+    {
+        // Only the newest pose itself can be returned, nothing past it
+        if (before.time != time)
+        {
+            return false;
+        }
+        pose = before.pose;
+        return true;
+    }
+
+    const TimedPose& after = this->poseHistory.at(low);
+    float fraction = static_cast<float>(time - before.time) / (after.time - before.time);
+    pose = interpolatePose(before.pose, after.pose, fraction);
+    return true;
+}
+
+void OdometryProcessor::enableAdaptiveRollover(float maxWheelSpeed)
+{
+    this->adaptiveMaxWheelSpeed = maxWheelSpeed;
+}
 
-    if (settled())
+void OdometryProcessor::enableFrameValidation(const ValidationConfig& config)
+{
+    this->validationEnabled = true;
+    this->validationConfig = config;
+    // Wheel speeds are learned again from the next frame
+    this->forwardRatesKnown = false;
+    this->consecutiveRejects = 0;
+    this->rejectedSeconds = 0.0;
+}
+
+void OdometryProcessor::validateFrame()
+{
+    this->validationCounters.framesChecked++;
+
+    if (this->deltaTime <= 0.0f)
     {
-        this->calculateMetersMotorTraveledInFrame(Motor::LEFT);
-        this->calculateMetersMotorTraveledInFrame(Motor::RIGHT);
+        return;
+    }
+    // After rejected frames the readings are measured from the last good frame, so the limits
+    // cover all the time since then
+    float seconds = this->deltaTime / 1000.0f + this->rejectedSeconds;
 
-        this->calculateFrameDistance();
-        this->calculateTheta();
+    // Work in meters with forward motion positive on both wheels
+    float leftScale = this->derived.metersPerDegree[Motor::LEFT];
+    float rightScale = this->derived.metersPerDegree[Motor::RIGHT];
+    float left = this->degreesTraveledInFrame[Motor::LEFT] * leftScale;
+    float right = this->degreesTraveledInFrame[Motor::RIGHT] * rightScale;
+    float rawLeft = left;
+    float rawRight = right;
+    bool glitch = false;
 
-        this->calculateDistanceMovedX();
-        this->calculateDistanceMovedY();
+    if (this->validationConfig.maxWheelSpeed > 0.0f)
+    {
+        float limit = this->validationConfig.maxWheelSpeed * seconds;
+        if (fabsf(left) > limit || fabsf(right) > limit)
+        {
+            this->validationCounters.speedViolations++;
+            glitch = true;
+            left = std::max(-limit, std::min(left, limit));
+            right = std::max(-limit, std::min(right, limit));
+        }
     }
+
+    // The first frame has no earlier speed to compare against, it only sets the speeds
+    if (this->validationConfig.maxWheelAcceleration > 0.0f && this->forwardRatesKnown)
+    {
+        float limit = this->validationConfig.maxWheelAcceleration * seconds * seconds;
+        float expectedLeft = this->leftForwardRate * seconds;
+        float expectedRight = this->rightForwardRate * seconds;
+        if (fabsf(left - expectedLeft) > limit || fabsf(right - expectedRight) > limit)
+        {
+            this->validationCounters.accelerationViolations++;
+            glitch = true;
+            left = std::max(expectedLeft - limit, std::min(left, expectedLeft + limit));
+            right = std::max(expectedRight - limit, std::min(right, expectedRight + limit));
+        }
+    }
+
+    if (this->validationConfig.maxWheelSpeedDifference > 0.0f)
+    {
+        float limit = this->validationConfig.maxWheelSpeedDifference * seconds;
+        float difference = right - left;
+        if (fabsf(difference) > limit)
+        {
+            this->validationCounters.speedDifferenceViolations++;
+            glitch = true;
+            // Pull both wheels towards their average until the difference is in the limit
+            float average = (left + right) / 2.0f;
+            float half = difference > 0.0f ? limit / 2.0f : -limit / 2.0f;
+            left = average - half;
+            right = average + half;
+        }
+    }
+
+    if (glitch && this->validationConfig.action == GlitchAction::REJECT &&
+        this->consecutiveRejects < GLITCH_RESYNC_FRAMES)
+    {
+        this->validationCounters.rejectedFrames++;
+        this->totalDegreesTraveled[Motor::LEFT] -= this->degreesTraveledInFrame[Motor::LEFT];
+        this->totalDegreesTraveled[Motor::RIGHT] -= this->degreesTraveledInFrame[Motor::RIGHT];
+        this->degreesTraveledInFrame[Motor::LEFT] = 0.0;
+        this->degreesTraveledInFrame[Motor::RIGHT] = 0.0;
+        this->previousLeftDegree = 0.0;
+        this->previousRightDegree = 0.0;
+
+        // Keep measuring from the last good readings
+        this->consecutiveRejects++;
+        this->rejectedSeconds = seconds;
+        this->currentReadings[Motor::LEFT] = this->lastReadings[Motor::LEFT];
+        this->currentReadings[Motor::RIGHT] = this->lastReadings[Motor::RIGHT];
+        return;
+    }
+
+    if (glitch && this->validationConfig.action == GlitchAction::REJECT)
+    {
+        // The glitch has persisted long enough that the readings must be real. Take the whole move
+        // since the last good frame and learn the wheel speeds from it.
+        left = rawLeft;
+        right = rawRight;
+    }
+    else if (glitch)
+    {
+        this->validationCounters.clampedFrames++;
+        float leftDegrees = left / leftScale;
+        float rightDegrees = right / rightScale;
+        this->totalDegreesTraveled[Motor::LEFT] +=
+            leftDegrees - this->degreesTraveledInFrame[Motor::LEFT];
+        this->totalDegreesTraveled[Motor::RIGHT] +=
+            rightDegrees - this->degreesTraveledInFrame[Motor::RIGHT];
+        this->degreesTraveledInFrame[Motor::LEFT] = leftDegrees;
+        this->degreesTraveledInFrame[Motor::RIGHT] = rightDegrees;
+        this->previousLeftDegree = leftDegrees;
+        this->previousRightDegree = rightDegrees;
+    }
+
+    this->consecutiveRejects = 0;
+    this->rejectedSeconds = 0.0;
+    this->forwardRatesKnown = true;
+    this->leftForwardRate = left / seconds;
+    this->rightForwardRate = right / seconds;
 }
 
-// Getters
-float OdometryProcessor::getCurrentReading(Motor motor) { return this->currentReadings[motor]; }
+void OdometryProcessor::enableCovariance(float leftNoise, float rightNoise)
+{
+    this->covarianceEnabled = true;
+    this->leftNoise = leftNoise;
+    this->rightNoise = rightNoise;
+}
 
-float OdometryProcessor::getLastReading(Motor motor) { return this->lastReadings[motor]; }
+void OdometryProcessor::propagateCovariance()
+{
+    float rightDistance = this->metersTraveledInFrame[Motor::RIGHT];
+    float leftDistance = this->metersTraveledInFrame[Motor::LEFT];
+    float frameDistance = this->distance.frameDistance;
+    float cosTheta = cosf(this->currentPosition.theta);
+    float sinTheta = sinf(this->currentPosition.theta);
 
-Distance OdometryProcessor::getDistance() { return this->distance; }
+    // Change in heading per meter of right wheel travel (left is the negative)
+    float ratio = (rightDistance - leftDistance) * this->derived.inverseWheelBase;
+    float headingRate = this->derived.inverseWheelBase / sqrtf(1.0f - ratio * ratio);
 
-int OdometryProcessor::getDeltaTime() { return this->deltaTime; }
+    // Jacobian of the new pose with respect to the old pose
+    float stateJacobian[3][3] = {{1, 0, -frameDistance * sinTheta},
+                                 {0, 1, frameDistance * cosTheta},
+                                 {0, 0, 1}};
 
-Velocity OdometryProcessor::getVelocity() { return this->velocity; }
+    // Jacobian of the new pose with respect to the (right, left) wheel distances
+    float wheelJacobian[3][2] = {
+        {0.5f * cosTheta - frameDistance * sinTheta * headingRate,
+         0.5f * cosTheta + frameDistance * sinTheta * headingRate},
+        {0.5f * sinTheta + frameDistance * cosTheta * headingRate,
+         0.5f * sinTheta - frameDistance * cosTheta * headingRate},
+        {headingRate, -headingRate}};
 
-Position OdometryProcessor::getPosition() { return this->currentPosition; }
+    // Wheel noise grows with the distance each wheel traveled
+    float wheelVariance[2] = {this->rightNoise * fabsf(rightDistance),
+                              this->leftNoise * fabsf(leftDistance)};
 
-float OdometryProcessor::getTotalDegreesTraveled(Motor motor)
+    // stateJacobian * covariance
+    const auto& previous = this->covariance.values;
+    float product[3][3];
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            product[row][col] = stateJacobian[row][0] * previous[col] +
+                                stateJacobian[row][1] * previous[3 + col] +
+                                stateJacobian[row][2] * previous[6 + col];
+        }
+    }
+
+    // product * stateJacobian^T + wheelJacobian * wheelVariance * wheelJacobian^T
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            this->covariance.values[row * 3 + col] =
+                product[row][0] * stateJacobian[col][0] + product[row][1] * stateJacobian[col][1] +
+                product[row][2] * stateJacobian[col][2] +
+                wheelJacobian[row][0] * wheelVariance[0] * wheelJacobian[col][0] +
+                wheelJacobian[row][1] * wheelVariance[1] * wheelJacobian[col][1];
+        }
+    }
+}
+
+void OdometryProcessor::enableGyroFusion(float gyroWeight)
 {
-    return this->totalDegreesTraveled[motor];
+    this->gyroFusionEnabled = true;
+    this->gyroWeight = gyroWeight;
+    this->gyroStarted = false;
+    this->gyroAngle = 0.0;
+    this->gyroTime = 0.0;
 }
 
-float OdometryProcessor::getDegreesTraveledInFrame(Motor motor)
+void OdometryProcessor::updateGyro(float zRate, uint16_t timestamp)
 {
-    return this->degreesTraveledInFrame[motor];
+    float rate = zRate - this->gyroBias;
+    // Turning before fusion is on or the processor settled must not show up in the first frame
+    if (this->gyroStarted && this->gyroFusionEnabled && this->hasSettled)
+    {
+        // Trapezoidal integration between samples
+        float seconds = elapsedTime(timestamp, this->gyroTimestamp) / 1000.0f;
+        this->gyroAngle += 0.5f * (rate + this->lastGyroRate) * seconds;
+        this->gyroTime += seconds;
+    }
+    this->gyroStarted = true;
+    this->lastGyroRate = rate;
+    this->gyroTimestamp = timestamp;
 }
 
-float OdometryProcessor::getTotalMetersTraveled(Motor motor)
+Position OdometryProcessor::predictPose(float secondsAhead) const
 {
-    return this->totalMetersTraveled[motor];
+    // Velocity is not finite until timestamps have been provided
+    if (!std::isfinite(this->velocity.linearX) || !std::isfinite(this->velocity.angularZ))
+    {
+        return this->currentPosition;
+    }
+
+    Position twist = {this->velocity.linearX * secondsAhead, 0.0f,
+                      this->velocity.angularZ * secondsAhead};
+    return composePose(this->currentPosition, exponentialMap(twist));
 }
 
-float OdometryProcessor::getMetersTraveledInFrame(Motor motor)
+bool OdometryProcessor::relativeTransform(uint16_t from, uint16_t to, Position& transform) const
 {
-    return this->metersTraveledInFrame[motor];
+    Position fromPose;
+    Position toPose;
+    if (!this->poseAt(from, fromPose) || !this->poseAt(to, toPose))
+    {
+        return false;
+    }
+    transform = relativePose(fromPose, toPose);
+    return true;
 }
@@ -0,0 +1,61 @@
+/**
+ * @file odometry_arena.cpp
+ * @brief File to implement processor slots in caller provided memory
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/odometry_arena.h"
+
+#include <memory>
+
+static_assert(sizeof(OdometryProcessor) >= sizeof(void*) &&
+                  alignof(OdometryProcessor) >= alignof(void*),
+              "a released slot holds the free list link");
+
+OdometryArena::OdometryArena(void* memory, size_t bytes) noexcept
+{
+    if (std::align(alignof(OdometryProcessor), sizeof(OdometryProcessor), memory, bytes) != nullptr)
+    {
+        this->slots = static_cast<OdometryProcessor*>(memory);
+        this->capacity = bytes / sizeof(OdometryProcessor);
+    }
+}
+
+void* OdometryArena::takeSlot() noexcept
+{
+    if (this->freeList != nullptr)
+    {
+        FreeSlot* slot = this->freeList;
+        this->freeList = slot->next;
+        this->size++;
+        return slot;
+    }
+    if (this->used == this->capacity)
+    {
+        return nullptr;
+    }
+    this->size++;
+    return this->slots + this->used++;
+}
+
+void OdometryArena::release(OdometryProcessor* processor) noexcept
+{
+    if (processor == nullptr)
+    {
+        return;
+    }
+    // Trivially destructible, so the slot can be reused as soon as the link is written over it
+    FreeSlot* slot = new (processor) FreeSlot{this->freeList};
+    this->freeList = slot;
+    this->size--;
+}
+
+void OdometryArena::reset() noexcept
+{
+    this->size = 0;
+    this->used = 0;
+    this->freeList = nullptr;
+}
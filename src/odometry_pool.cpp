@@ -0,0 +1,172 @@
+/**
+ * @file odometry_pool.cpp
+ * @brief File to implement the work stealing robot stream pool
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/odometry_pool.h"
+
+#include <algorithm>
+
+OdometryPool::OdometryPool(unsigned threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned thread = 0; thread < threadCount; thread++)
+    {
+        this->queues.push_back(std::make_unique<TaskQueue>());
+    }
+    // Queue 0 belongs to the thread calling process()
+    for (unsigned thread = 1; thread < threadCount; thread++)
+    {
+        this->workers.emplace_back(&OdometryPool::workerLoop, this, thread);
+    }
+}
+
+OdometryPool::~OdometryPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->jobMutex);
+        this->stopping = true;
+    }
+    this->jobStarted.notify_all();
+    for (auto& thread : this->workers)
+    {
+        thread.join();
+    }
+}
+
+void OdometryPool::process(const std::vector<RobotStream>& streams, size_t chunkFrames)
+{
+    if (streams.empty())
+    {
+        return;
+    }
+
+    this->streams = &streams;
+    this->chunkFrames = std::max<size_t>(1, chunkFrames);
+    this->remainingStreams = streams.size();
+
+    // Deal the streams out round robin, stealing evens out whatever imbalance is left
+    for (size_t stream = 0; stream < streams.size(); stream++)
+    {
+        TaskQueue& queue = *this->queues[stream % this->queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back({stream, 0});
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->jobMutex);
+        this->generation++;
+    }
+    this->jobStarted.notify_all();
+
+    this->runTasks(0);
+
+    std::unique_lock<std::mutex> lock(this->jobMutex);
+    this->jobFinished.wait(lock, [this]() { return this->remainingStreams == 0; });
+}
+
+void OdometryPool::workerLoop(size_t worker)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(this->jobMutex);
+            this->jobStarted.wait(lock,
+                                  [&]() { return this->stopping || this->generation != seen; });
+            if (this->stopping)
+            {
+                return;
+            }
+            seen = this->generation;
+        }
+        this->runTasks(worker);
+    }
+}
+
+void OdometryPool::runTasks(size_t worker)
+{
+    while (this->remainingStreams > 0)
+    {
+        uint64_t pushes;
+        {
+            std::lock_guard<std::mutex> lock(this->jobMutex);
+            pushes = this->taskPushes;
+        }
+        Task task;
+        if (this->popTask(worker, task) || this->stealTask(worker, task))
+        {
+            this->runTask(worker, task);
+            continue;
+        }
+
+        // Every remaining stream has a chunk in flight on another thread, sleep until one of them
+        // queues the rest of its stream or the last one finishes
+        std::unique_lock<std::mutex> lock(this->jobMutex);
+        this->taskAvailable.wait(
+            lock, [&]() { return this->remainingStreams == 0 || this->taskPushes != pushes; });
+    }
+}
+
+bool OdometryPool::popTask(size_t worker, Task& task)
+{
+    TaskQueue& queue = *this->queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool OdometryPool::stealTask(size_t worker, Task& task)
+{
+    for (size_t step = 1; step < this->queues.size(); step++)
+    {
+        TaskQueue& queue = *this->queues[(worker + step) % this->queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void OdometryPool::runTask(size_t worker, const Task& task)
+{
+    const RobotStream& stream = (*this->streams)[task.stream];
+    size_t count = std::min(this->chunkFrames, stream.count - task.offset);
+    stream.processor->processBatch(stream.frames + task.offset, count);
+
+    size_t offset = task.offset + count;
+    if (offset < stream.count)
+    {
+        TaskQueue& queue = *this->queues[worker];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back({task.stream, offset});
+        }
+        std::lock_guard<std::mutex> lock(this->jobMutex);
+        this->taskPushes++;
+        this->taskAvailable.notify_one();
+        return;
+    }
+
+    if (--this->remainingStreams == 0)
+    {
+        std::lock_guard<std::mutex> lock(this->jobMutex);
+        this->taskAvailable.notify_all();
+        this->jobFinished.notify_all();
+    }
+}
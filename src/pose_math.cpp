@@ -0,0 +1,83 @@
+/**
+ * @file pose_math.cpp
+ * @brief File to implement the SE(2) pose helpers
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/pose_math.h"
+
+/// Below this rotation (radians) the arc is treated as a straight line
+constexpr float SMALL_ANGLE = 1e-4;
+
+float normalizeAngle(float angle)
+{
+    while (angle > PI)
+    {
+        angle -= 2.0 * PI;
+    }
+    while (angle <= -PI)
+    {
+        angle += 2.0 * PI;
+    }
+    return angle;
+}
+
+Position composePose(const Position& a, const Position& b)
+{
+    float cosTheta = cosf(a.theta);
+    float sinTheta = sinf(a.theta);
+    return {a.x + cosTheta * b.x - sinTheta * b.y, a.y + sinTheta * b.x + cosTheta * b.y,
+            normalizeAngle(a.theta + b.theta)};
+}
+
+Position inversePose(const Position& pose)
+{
+    float cosTheta = cosf(pose.theta);
+    float sinTheta = sinf(pose.theta);
+    return {-cosTheta * pose.x - sinTheta * pose.y, sinTheta * pose.x - cosTheta * pose.y,
+            normalizeAngle(-pose.theta)};
+}
+
+Position relativePose(const Position& from, const Position& to)
+{
+    return composePose(inversePose(from), to);
+}
+
+Position exponentialMap(const Position& twist)
+{
+    float angle = twist.theta;
+    if (fabsf(angle) < SMALL_ANGLE)
+    {
+        return {twist.x, twist.y, angle};
+    }
+
+    // Integrate the twist along its arc
+    float sinRatio = sinf(angle) / angle;
+    float cosRatio = (1.0f - cosf(angle)) / angle;
+    return {sinRatio * twist.x - cosRatio * twist.y, cosRatio * twist.x + sinRatio * twist.y,
+            normalizeAngle(angle)};
+}
+
+Position logarithmMap(const Position& pose)
+{
+    float angle = pose.theta;
+    if (fabsf(angle) < SMALL_ANGLE)
+    {
+        return {pose.x, pose.y, angle};
+    }
+
+    // Inverse of the arc integration in exponentialMap
+    float halfAngle = angle / 2.0f;
+    float a = halfAngle * cosf(halfAngle) / sinf(halfAngle);
+    return {a * pose.x + halfAngle * pose.y, -halfAngle * pose.x + a * pose.y, angle};
+}
+
+Position interpolatePose(const Position& a, const Position& b, float fraction)
+{
+    Position twist = logarithmMap(relativePose(a, b));
+    Position step = exponentialMap({twist.x * fraction, twist.y * fraction, twist.theta * fraction});
+    return composePose(a, step);
+}
@@ -0,0 +1,225 @@
+/**
+ * @file pose_ring.cpp
+ * @brief File to implement the shared memory pose ring
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/pose_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+/**
+ * @brief Number of bytes needed for a ring of the given capacity
+ *
+ */
+static size_t ringSize(uint32_t capacity)
+{
+    return sizeof(PoseRingHeader) + static_cast<size_t>(capacity) * sizeof(PoseRingSlot);
+}
+
+PoseRingWriter::~PoseRingWriter()
+{
+    if (this->header != nullptr)
+    {
+        munmap(this->header, this->size);
+        shm_unlink(this->name);
+    }
+}
+
+bool PoseRingWriter::create(const char* name, uint32_t capacity)
+{
+    if (this->header != nullptr || capacity == 0 || std::strlen(name) >= sizeof(this->name))
+    {
+        return false;
+    }
+
+    shm_unlink(name);
+    int descriptor = shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+    size_t size = ringSize(capacity);
+    void* memory = MAP_FAILED;
+    if (ftruncate(descriptor, static_cast<off_t>(size)) == 0)
+    {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return false;
+    }
+
+    // ftruncate zero fills, which is a valid empty ring. Magic goes last so readers that open
+    // while the ring is being set up reject it.
+    std::strcpy(this->name, name);
+    this->header = static_cast<PoseRingHeader*>(memory);
+    this->slots = reinterpret_cast<PoseRingSlot*>(this->header + 1);
+    this->size = size;
+    this->header->capacity = capacity;
+    this->header->published.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->header->magic = POSE_RING_MAGIC;
+    return true;
+}
+
+void PoseRingWriter::publish(const OdometryState& state)
+{
+    if (this->header == nullptr)
+    {
+        return;
+    }
+
+    uint64_t frame = this->header->published.load(std::memory_order_relaxed);
+    PosePacket packet = makePosePacket(state, static_cast<uint32_t>(frame));
+    uint32_t words[POSE_RING_WORDS];
+    std::memcpy(words, &packet, sizeof(packet));
+
+    PoseRingSlot& slot = this->slots[frame % this->header->capacity];
+    slot.stamp.store(2 * frame + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int word = 0; word < POSE_RING_WORDS; word++)
+    {
+        slot.words[word].store(words[word], std::memory_order_relaxed);
+    }
+    slot.stamp.store(2 * frame + 2, std::memory_order_release);
+    this->header->published.store(frame + 1, std::memory_order_release);
+}
+
+PoseRingReader::~PoseRingReader()
+{
+    if (this->header != nullptr)
+    {
+        munmap(const_cast<PoseRingHeader*>(this->header), this->size);
+    }
+}
+
+bool PoseRingReader::open(const char* name)
+{
+    if (this->header != nullptr)
+    {
+        return false;
+    }
+
+    int descriptor = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    void* memory = MAP_FAILED;
+    size_t size = 0;
+    if (fstat(descriptor, &status) == 0 && status.st_size >= static_cast<off_t>(ringSize(0)))
+    {
+        size = static_cast<size_t>(status.st_size);
+        memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (memory == MAP_FAILED)
+    {
+        return false;
+    }
+
+    auto header = static_cast<const PoseRingHeader*>(memory);
+    if (header->magic != POSE_RING_MAGIC || header->capacity == 0 ||
+        ringSize(header->capacity) > size)
+    {
+        munmap(memory, size);
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    this->header = header;
+    this->slots = reinterpret_cast<const PoseRingSlot*>(header + 1);
+    this->size = size;
+    this->cursor = header->published.load(std::memory_order_acquire);
+    return true;
+}
+
+bool PoseRingReader::next(PosePacket& packet)
+{
+    if (this->header == nullptr)
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        uint64_t published = this->header->published.load(std::memory_order_acquire);
+        if (this->cursor >= published)
+        {
+            return false;
+        }
+        // Skip ahead to the oldest frame still in the ring
+        if (published - this->cursor > this->header->capacity)
+        {
+            uint64_t oldest = published - this->header->capacity;
+            this->missedFrames += oldest - this->cursor;
+            this->cursor = oldest;
+        }
+        // Published frames are always complete, so a failed read means the writer has started
+        // overwriting this one. Count it as missed rather than waiting on the writer.
+        bool read = this->readFrame(this->cursor, packet);
+        this->cursor++;
+        if (read)
+        {
+            return true;
+        }
+        this->missedFrames++;
+    }
+}
+
+bool PoseRingReader::latest(PosePacket& packet) const
+{
+    if (this->header == nullptr)
+    {
+        return false;
+    }
+
+    // The newest slot can be mid write, for example with a capacity of 1, so fall back to older
+    // frames and give up once every slot has been tried
+    uint64_t published = this->header->published.load(std::memory_order_acquire);
+    uint64_t oldest = published > this->header->capacity ? published - this->header->capacity : 0;
+    for (uint64_t frame = published; frame > oldest; frame--)
+    {
+        if (this->readFrame(frame - 1, packet))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PoseRingReader::readFrame(uint64_t frame, PosePacket& packet) const
+{
+    const PoseRingSlot& slot = this->slots[frame % this->header->capacity];
+    uint64_t expected = 2 * frame + 2;
+    if (slot.stamp.load(std::memory_order_acquire) != expected)
+    {
+        return false;
+    }
+
+    uint32_t words[POSE_RING_WORDS];
+    for (int word = 0; word < POSE_RING_WORDS; word++)
+    {
+        words[word] = slot.words[word].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.stamp.load(std::memory_order_relaxed) != expected)
+    {
+        return false;
+    }
+
+    std::memcpy(&packet, words, sizeof(packet));
+    return true;
+}
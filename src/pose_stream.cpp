@@ -0,0 +1,200 @@
+/**
+ * @file pose_stream.cpp
+ * @brief File to implement batched binary pose streaming
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/pose_stream.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+
+PosePacket makePosePacket(const OdometryState& state, uint32_t sequence)
+{
+    PosePacket packet;
+    packet.magic = POSE_PACKET_MAGIC;
+    packet.timestamp = state.timestamp;
+    packet.sequence = sequence;
+    packet.x = state.position.x;
+    packet.y = state.position.y;
+    packet.theta = state.position.theta;
+    packet.linearX = state.velocity.linearX;
+    packet.angularZ = state.velocity.angularZ;
+    packet.frameDistance = state.distance.frameDistance;
+    packet.totalDistance = state.distance.totalDistance;
+    return packet;
+}
+
+bool decodePosePacket(const void* data, size_t size, PosePacket& packet)
+{
+    if (size != sizeof(PosePacket))
+    {
+        return false;
+    }
+    PosePacket decoded;
+    std::memcpy(&decoded, data, sizeof(decoded));
+    if (decoded.magic != POSE_PACKET_MAGIC)
+    {
+        return false;
+    }
+    packet = decoded;
+    return true;
+}
+
+PoseStreamServer::~PoseStreamServer()
+{
+    if (this->udpSocket >= 0)
+    {
+        close(this->udpSocket);
+    }
+    if (this->unixSocket >= 0)
+    {
+        close(this->unixSocket);
+    }
+}
+
+bool PoseStreamServer::addUdpSubscriber(const char* address, uint16_t port, uint32_t decimation)
+{
+    sockaddr_in destination = {};
+    destination.sin_family = AF_INET;
+    destination.sin_port = htons(port);
+    if (inet_pton(AF_INET, address, &destination.sin_addr) != 1)
+    {
+        return false;
+    }
+    return this->addSubscriber(reinterpret_cast<const sockaddr*>(&destination),
+                               sizeof(destination), AF_INET, decimation);
+}
+
+bool PoseStreamServer::addUnixSubscriber(const char* path, uint32_t decimation)
+{
+    sockaddr_un destination = {};
+    destination.sun_family = AF_UNIX;
+    if (std::strlen(path) >= sizeof(destination.sun_path))
+    {
+        return false;
+    }
+    std::strcpy(destination.sun_path, path);
+    return this->addSubscriber(reinterpret_cast<const sockaddr*>(&destination),
+                               sizeof(destination), AF_UNIX, decimation);
+}
+
+bool PoseStreamServer::addSubscriber(const sockaddr* address, socklen_t length, int family,
+                                     uint32_t decimation)
+{
+    if (decimation == 0 || this->subscriberCount >= MAX_STREAM_SUBSCRIBERS)
+    {
+        return false;
+    }
+    int socket = this->openSocket(family);
+    if (socket < 0)
+    {
+        return false;
+    }
+
+    Subscriber& subscriber = this->subscribers[this->subscriberCount++];
+    std::memcpy(&subscriber.address, address, length);
+    subscriber.addressLength = length;
+    subscriber.socket = socket;
+    subscriber.decimation = decimation;
+    return true;
+}
+
+int PoseStreamServer::openSocket(int family)
+{
+    // One socket per address family is shared by every subscriber of that family
+    int& socket = family == AF_UNIX ? this->unixSocket : this->udpSocket;
+    if (socket < 0)
+    {
+        socket = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+    return socket;
+}
+
+void PoseStreamServer::publish(const OdometryState& state)
+{
+    uint32_t sequence = this->sequence++;
+    int packet = this->packetCount;
+    bool queued = false;
+    for (int subscriber = 0; subscriber < this->subscriberCount; subscriber++)
+    {
+        if (sequence % this->subscribers[subscriber].decimation == 0)
+        {
+            this->queued[this->queuedCount++] = {subscriber, packet};
+            queued = true;
+        }
+    }
+    if (!queued)
+    {
+        return;
+    }
+
+    this->packets[this->packetCount++] = makePosePacket(state, sequence);
+    if (this->packetCount == STREAM_BATCH_FRAMES)
+    {
+        this->flush();
+    }
+}
+
+int PoseStreamServer::flush()
+{
+    int sent = 0;
+    if (this->udpSocket >= 0)
+    {
+        sent += this->sendQueued(this->udpSocket);
+    }
+    if (this->unixSocket >= 0)
+    {
+        sent += this->sendQueued(this->unixSocket);
+    }
+    this->packetCount = 0;
+    this->queuedCount = 0;
+    return sent;
+}
+
+int PoseStreamServer::sendQueued(int socket)
+{
+    // Every message points straight at the shared packet, nothing is copied per subscriber
+    iovec vectors[STREAM_BATCH_FRAMES * MAX_STREAM_SUBSCRIBERS];
+    mmsghdr messages[STREAM_BATCH_FRAMES * MAX_STREAM_SUBSCRIBERS];
+    int count = 0;
+    for (int index = 0; index < this->queuedCount; index++)
+    {
+        Subscriber& subscriber = this->subscribers[this->queued[index].subscriber];
+        if (subscriber.socket != socket)
+        {
+            continue;
+        }
+        vectors[count] = {&this->packets[this->queued[index].packet], sizeof(PosePacket)};
+        messages[count] = {};
+        messages[count].msg_hdr.msg_name = &subscriber.address;
+        messages[count].msg_hdr.msg_namelen = subscriber.addressLength;
+        messages[count].msg_hdr.msg_iov = &vectors[count];
+        messages[count].msg_hdr.msg_iovlen = 1;
+        count++;
+    }
+
+    int sent = 0;
+    int offset = 0;
+    while (offset < count)
+    {
+        int result = sendmmsg(socket, &messages[offset], count - offset, 0);
+        if (result <= 0)
+        {
+            // The message at offset failed (full buffer, missing subscriber), skip past it
+            this->droppedPackets++;
+            offset++;
+            continue;
+        }
+        sent += result;
+        offset += result;
+    }
+    return sent;
+}
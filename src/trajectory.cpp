@@ -0,0 +1,163 @@
+/**
+ * @file trajectory.cpp
+ * @brief File to implement parallel prefix scan trajectory reconstruction
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/trajectory.h"
+#include "encoder_to_odom/pose_math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Encoder degrees between two readings, unwrapping a single rollover either way
+ *
+ */
+static float deltaDegrees(float current, float last, float rolloverThreshold)
+{
+    // Same as OdometryProcessor::calculateDeltaDegrees, written as selects so it vectorizes
+    float delta = current - last;
+    delta += delta > rolloverThreshold ? -THREE_SIXTY : 0.0f;
+    delta += delta < -rolloverThreshold ? THREE_SIXTY : 0.0f;
+    return delta;
+}
+
+/// Frames whose wheel moves are computed ahead of integrating them
+constexpr size_t DELTA_CHUNK = 256;
+
+/**
+ * @brief Wheel moves in meters for a run of frames
+ *
+ * Kept apart from the integration so this loop has no calls or loop carried state and the
+ * compiler can vectorize it.
+ *
+ * @param begin First frame, must be at least 1
+ * @param count Number of frames, at most DELTA_CHUNK
+ */
+static void wheelMoves(const EncoderFrame* frames, size_t begin, size_t count,
+                       float leftMetersPerDegree, float rightMetersPerDegree,
+                       float rolloverThreshold, float* leftMoves, float* rightMoves)
+{
+    const EncoderFrame* current = frames + begin;
+    const EncoderFrame* last = frames + begin - 1;
+    for (size_t index = 0; index < count; index++)
+    {
+        leftMoves[index] = leftMetersPerDegree *
+                           deltaDegrees(current[index].left, last[index].left, rolloverThreshold);
+        rightMoves[index] = rightMetersPerDegree * deltaDegrees(current[index].right,
+                                                                last[index].right,
+                                                                rolloverThreshold);
+    }
+}
+
+/**
+ * @brief Integrate a block of frames from the given pose
+ *
+ * @param begin First frame of the block, must be at least 1
+ */
+static void integrateBlock(const TrajectoryConfig& config, const EncoderFrame* frames,
+                           size_t begin, size_t end, Position origin, Position* poses)
+{
+    const DriveGeometry& geometry = config.geometry;
+    float leftMetersPerDegree = (config.leftIncrease ? 1.0f : -1.0f) *
+                                geometry.leftWheel.circumference /
+                                (THREE_SIXTY * geometry.leftWheel.gearRatio);
+    float rightMetersPerDegree = (config.rightIncrease ? 1.0f : -1.0f) *
+                                 geometry.rightWheel.circumference /
+                                 (THREE_SIXTY * geometry.rightWheel.gearRatio);
+    float inverseWheelBase = 1.0f / geometry.wheelBase;
+
+    float leftMoves[DELTA_CHUNK];
+    float rightMoves[DELTA_CHUNK];
+    Position pose = origin;
+    for (size_t chunk = begin; chunk < end; chunk += DELTA_CHUNK)
+    {
+        size_t count = std::min(DELTA_CHUNK, end - chunk);
+        wheelMoves(frames, chunk, count, leftMetersPerDegree, rightMetersPerDegree,
+                   config.rolloverThreshold, leftMoves, rightMoves);
+
+        for (size_t index = 0; index < count; index++)
+        {
+            // The processor turns first and then moves along the new heading
+            float distance = (rightMoves[index] + leftMoves[index]) / 2.0f;
+            float angle = asinf((rightMoves[index] - leftMoves[index]) * inverseWheelBase);
+            pose = composePose(pose, {cosf(angle) * distance, sinf(angle) * distance, angle});
+            poses[chunk + index] = pose;
+        }
+    }
+}
+
+void reconstructTrajectory(const TrajectoryConfig& config, const EncoderFrame* frames,
+                           size_t count, Position* poses, unsigned threadCount)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t blocks = std::min<size_t>(threadCount, count / TRAJECTORY_MIN_BLOCK);
+    blocks = std::max<size_t>(1, blocks);
+    size_t blockSize = (count + blocks - 1) / blocks;
+    // Frame 0 only gives the starting readings, so the first block starts integrating at 1
+    auto blockBegin = [&](size_t block)
+    { return std::min(count, std::max<size_t>(1, block * blockSize)); };
+
+    poses[0] = config.start;
+
+    // Integrate every block from its own origin, the first block can start from the real pose
+    auto integrate = [&](size_t block)
+    {
+        Position origin = block == 0 ? config.start : Position{0.0f, 0.0f, 0.0f};
+        integrateBlock(config, frames, blockBegin(block), blockBegin(block + 1), origin, poses);
+    };
+    std::vector<std::thread> workers;
+    for (size_t block = 1; block < blocks; block++)
+    {
+        workers.emplace_back(integrate, block);
+    }
+    integrate(0);
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+    workers.clear();
+
+    // Chain the block end points to find where each block really starts
+    std::vector<Position> origins(blocks);
+    origins[0] = config.start;
+    for (size_t block = 1; block < blocks; block++)
+    {
+        const Position& previousEnd = poses[blockBegin(block) - 1];
+        origins[block] = block == 1 ? previousEnd : composePose(origins[block - 1], previousEnd);
+    }
+
+    // Move each block onto its starting pose
+    auto place = [&](size_t block)
+    {
+        for (size_t frame = blockBegin(block); frame < blockBegin(block + 1); frame++)
+        {
+            poses[frame] = composePose(origins[block], poses[frame]);
+        }
+    };
+    for (size_t block = 2; block < blocks; block++)
+    {
+        workers.emplace_back(place, block);
+    }
+    if (blocks > 1)
+    {
+        place(1);
+    }
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+}
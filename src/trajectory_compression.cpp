@@ -0,0 +1,216 @@
+/**
+ * @file trajectory_compression.cpp
+ * @brief File to implement streaming trajectory simplification and pose delta encoding
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2026 LUCI Mobility, Inc. All Rights Reserved.
+ *
+ */
+
+#include "encoder_to_odom/trajectory_compression.h"
+#include "encoder_to_odom/pose_math.h"
+
+#include <algorithm>
+#include <cmath>
+
+TrajectorySimplifier::TrajectorySimplifier(float maxPositionError, float maxHeadingError)
+{
+    // Per axis error that keeps the distance within maxPositionError
+    this->tolerance[0] = maxPositionError / sqrtf(2.0f);
+    this->tolerance[1] = maxPositionError / sqrtf(2.0f);
+    this->tolerance[2] = maxHeadingError;
+}
+
+bool TrajectorySimplifier::push(const TimedPose& sample, TimedPose& vertex)
+{
+    if (!this->started)
+    {
+        this->started = true;
+        this->anchorTime = sample.time;
+        this->anchor[0] = sample.pose.x;
+        this->anchor[1] = sample.pose.y;
+        this->anchor[2] = sample.pose.theta;
+        this->lastTime = sample.time;
+        std::copy(this->anchor, this->anchor + CHANNELS, this->last);
+        vertex = sample;
+        return true;
+    }
+    if (sample.time <= this->lastTime)
+    {
+        return false;
+    }
+
+    float values[CHANNELS] = {sample.pose.x, sample.pose.y,
+                              this->last[2] + normalizeAngle(sample.pose.theta - this->last[2])};
+    bool finished = false;
+    bool turnedTooFar = fabsf(values[2] - this->anchor[2]) > PI / 2.0f;
+    if (this->open && (turnedTooFar || !this->narrow(sample.time, values, false)))
+    {
+        vertex = this->closeSegment();
+        finished = true;
+    }
+    if (!this->open)
+    {
+        this->narrow(sample.time, values, true);
+        this->open = true;
+    }
+    this->lastTime = sample.time;
+    std::copy(values, values + CHANNELS, this->last);
+    return finished;
+}
+
+bool TrajectorySimplifier::finish(TimedPose& vertex)
+{
+    if (!this->open)
+    {
+        return false;
+    }
+    vertex = this->closeSegment();
+    return true;
+}
+
+bool TrajectorySimplifier::narrow(int64_t time, const float* values, bool first)
+{
+    float elapsed = static_cast<float>(time - this->anchorTime);
+    float newLow[CHANNELS];
+    float newHigh[CHANNELS];
+    for (int channel = 0; channel < CHANNELS; channel++)
+    {
+        float change = values[channel] - this->anchor[channel];
+        newLow[channel] = (change - this->tolerance[channel]) / elapsed;
+        newHigh[channel] = (change + this->tolerance[channel]) / elapsed;
+        if (!first)
+        {
+            newLow[channel] = std::max(newLow[channel], this->low[channel]);
+            newHigh[channel] = std::min(newHigh[channel], this->high[channel]);
+            if (newLow[channel] > newHigh[channel])
+            {
+                return false;
+            }
+        }
+    }
+    std::copy(newLow, newLow + CHANNELS, this->low);
+    std::copy(newHigh, newHigh + CHANNELS, this->high);
+    return true;
+}
+
+TimedPose TrajectorySimplifier::closeSegment()
+{
+    float elapsed = static_cast<float>(this->lastTime - this->anchorTime);
+    for (int channel = 0; channel < CHANNELS; channel++)
+    {
+        float slope = (this->low[channel] + this->high[channel]) / 2.0f;
+        this->anchor[channel] += slope * elapsed;
+    }
+    this->anchorTime = this->lastTime;
+    this->open = false;
+    return {this->anchorTime,
+            {this->anchor[0], this->anchor[1], normalizeAngle(this->anchor[2])}};
+}
+
+Position interpolateVertices(const TimedPose& a, const TimedPose& b, int64_t time)
+{
+    if (b.time == a.time)
+    {
+        return a.pose;
+    }
+    float fraction = static_cast<float>(time - a.time) / static_cast<float>(b.time - a.time);
+    return {a.pose.x + (b.pose.x - a.pose.x) * fraction,
+            a.pose.y + (b.pose.y - a.pose.y) * fraction,
+            normalizeAngle(a.pose.theta + normalizeAngle(b.pose.theta - a.pose.theta) * fraction)};
+}
+
+/**
+ * @brief Write a signed value as a zigzag LEB128 varint
+ *
+ * @return size_t bytes written, at most 10
+ */
+static size_t writeVarint(int64_t value, uint8_t* out)
+{
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    size_t size = 0;
+    while (zigzag >= 0x80)
+    {
+        out[size++] = static_cast<uint8_t>(zigzag) | 0x80;
+        zigzag >>= 7;
+    }
+    out[size++] = static_cast<uint8_t>(zigzag);
+    return size;
+}
+
+/**
+ * @brief Read a value written by writeVarint
+ *
+ * @return size_t bytes read, 0 if the data ends first
+ */
+static size_t readVarint(const uint8_t* data, size_t size, int64_t& value)
+{
+    uint64_t zigzag = 0;
+    for (size_t index = 0; index < size && index < 10; index++)
+    {
+        zigzag |= static_cast<uint64_t>(data[index] & 0x7F) << (7 * index);
+        if ((data[index] & 0x80) == 0)
+        {
+            value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+            return index + 1;
+        }
+    }
+    return 0;
+}
+
+PoseDeltaEncoder::PoseDeltaEncoder(float maxPositionError, float maxHeadingError)
+{
+    // Rounding x and y each to half a step keeps the distance within maxPositionError
+    this->positionStep = std::sqrt(2.0) * maxPositionError;
+    this->headingStep = 2.0 * maxHeadingError;
+}
+
+size_t PoseDeltaEncoder::encode(const TimedPose& pose, uint8_t* out)
+{
+    int64_t current[4] = {pose.time, std::llround(pose.pose.x / this->positionStep),
+                          std::llround(pose.pose.y / this->positionStep),
+                          std::llround(normalizeAngle(pose.pose.theta) / this->headingStep)};
+    size_t size = 0;
+    for (int field = 0; field < 4; field++)
+    {
+        size += writeVarint(current[field] - this->last[field], out + size);
+        this->last[field] = current[field];
+    }
+    return size;
+}
+
+void PoseDeltaEncoder::reset() noexcept { std::fill(this->last, this->last + 4, 0); }
+
+PoseDeltaDecoder::PoseDeltaDecoder(float maxPositionError, float maxHeadingError)
+{
+    this->positionStep = std::sqrt(2.0) * maxPositionError;
+    this->headingStep = 2.0 * maxHeadingError;
+}
+
+bool PoseDeltaDecoder::decode(const uint8_t* data, size_t size, size_t& consumed, TimedPose& pose)
+{
+    int64_t current[4];
+    size_t used = 0;
+    for (int field = 0; field < 4; field++)
+    {
+        int64_t delta;
+        size_t read = readVarint(data + used, size - used, delta);
+        if (read == 0)
+        {
+            consumed = 0;
+            return false;
+        }
+        used += read;
+        current[field] = this->last[field] + delta;
+    }
+
+    std::copy(current, current + 4, this->last);
+    consumed = used;
+    pose.time = current[0];
+    pose.pose.x = static_cast<float>(current[1] * this->positionStep);
+    pose.pose.y = static_cast<float>(current[2] * this->positionStep);
+    pose.pose.theta = normalizeAngle(static_cast<float>(current[3] * this->headingStep));
+    return true;
+}
+
+void PoseDeltaDecoder::reset() noexcept { std::fill(this->last, this->last + 4, 0); }
@@ -0,0 +1,108 @@
+#include "encoder_to_odom/async_odometry.h"
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Follow a robot until its byte source ends
+ *
+ * @return Async<int> number of poses received
+ */
+Async<int> followRobot(AsyncOdometry<ByteChannel>& odometry, Position& last)
+{
+    int poses = 0;
+    while (auto state = co_await odometry.nextPose())
+    {
+        last = state->position;
+        poses++;
+    }
+    co_return poses;
+}
+
+/**
+ * @brief Simulated robot, its link and the coroutine following it
+ *
+ */
+struct SimulatedRobot
+{
+    explicit SimulatedRobot(AsyncExecutor& executor)
+        : processor(1.0f, 0.5f, 1.0f, 180.0f), channel(executor), odometry(processor, channel),
+          task(followRobot(odometry, last))
+    {
+    }
+
+    OdometryProcessor processor;
+    ByteChannel channel;
+    AsyncOdometry<ByteChannel> odometry;
+    Position last = {};
+    Async<int> task;
+};
+
+// Check a single executor thread can follow many robots fed byte by byte out of step
+TEST(AsyncOdometryTests, ManyRobots)
+{
+    constexpr int ROBOTS = 200;
+    constexpr int FRAMES = 20;
+    AsyncExecutor executor;
+    std::vector<std::unique_ptr<SimulatedRobot>> robots;
+    for (int robot = 0; robot < ROBOTS; robot++)
+    {
+        robots.push_back(std::make_unique<SimulatedRobot>(executor));
+        robots.back()->task.start();
+    }
+
+    // Each robot turns at its own rate, half a packet at a time
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        for (int robot = 0; robot < ROBOTS; robot++)
+        {
+            uint8_t packet[ENCODER_PACKET_MAX_SIZE];
+            EncoderFrame encoderFrame = {10.0f * frame, (10.0f + 0.05f * robot) * frame,
+                                         static_cast<uint16_t>(100 * frame)};
+            size_t size = encodeEncoderPacket(encoderFrame, packet);
+            robots[robot]->channel.write(packet, size / 2);
+            executor.runUntilIdle();
+            robots[robot]->channel.write(packet + size / 2, size - size / 2);
+        }
+        executor.runUntilIdle();
+    }
+    for (auto& robot : robots)
+    {
+        robot->channel.close();
+    }
+    executor.runUntilIdle();
+
+    for (int robot = 0; robot < ROBOTS; robot++)
+    {
+        auto& simulated = *robots[robot];
+        ASSERT_TRUE(simulated.task.done());
+        ASSERT_EQ(FRAMES, simulated.task.result());
+        ASSERT_EQ(simulated.processor.getPosition().theta, simulated.last.theta);
+    }
+    ASSERT_GT(robots.back()->last.theta, robots.front()->last.theta);
+}
+
+// Check a pose is only produced once a whole packet has arrived
+TEST(AsyncOdometryTests, WaitsForWholePacket)
+{
+    AsyncExecutor executor;
+    SimulatedRobot robot(executor);
+    robot.task.start();
+
+    uint8_t packet[ENCODER_PACKET_MAX_SIZE];
+    size_t size = encodeEncoderPacket({90.0f, 90.0f, 1000}, packet);
+    robot.channel.write(packet, size - 1);
+    executor.runUntilIdle();
+    ASSERT_EQ(0.0f, robot.processor.getTotalDegreesTraveled(Motor::LEFT));
+
+    robot.channel.write(packet + size - 1, 1);
+    executor.runUntilIdle();
+    ASSERT_EQ(90.0f, robot.processor.getCurrentReading(Motor::LEFT));
+    ASSERT_FALSE(robot.task.done());
+
+    robot.channel.close();
+    executor.runUntilIdle();
+    ASSERT_TRUE(robot.task.done());
+    ASSERT_EQ(1, robot.task.result());
+}
@@ -0,0 +1,166 @@
+#include "encoder_to_odom/calibration.h"
+#include <gtest/gtest.h>
+
+// Geometry the recorded runs were driven with
+constexpr float GEAR = 2.38462;
+constexpr float TRUE_LEFT_CIRCUMFERENCE = 1.0421;
+constexpr float TRUE_RIGHT_CIRCUMFERENCE = 1.0335;
+constexpr float TRUE_WHEEL_BASE = 0.5180;
+
+// Geometry the robot is configured with before calibrating
+constexpr float NOMINAL_CIRCUMFERENCE = 1.0373;
+constexpr float NOMINAL_WHEEL_BASE = 0.5065;
+
+/**
+ * @brief Add frames that move each wheel the given distance to a run
+ *
+ */
+void addFrames(CalibrationRun& run, int frames, float leftMeters, float rightMeters)
+{
+    for (int frame = 0; frame < frames; frame++)
+    {
+        run.leftDegrees.push_back(leftMeters / TRUE_LEFT_CIRCUMFERENCE * THREE_SIXTY * GEAR);
+        run.rightDegrees.push_back(rightMeters / TRUE_RIGHT_CIRCUMFERENCE * THREE_SIXTY * GEAR);
+    }
+}
+
+/**
+ * @brief Record a 2m square driven in one direction, ending back at the start as measured
+ *
+ * @param turnSign 1 for counter clockwise, -1 for clockwise
+ */
+CalibrationRun squareRun(float turnSign)
+{
+    CalibrationRun run;
+    // Quarter turn in place split over 20 frames
+    float turnStep = TRUE_WHEEL_BASE * sinf(PI / 2 / 20) / 2;
+    for (int side = 0; side < 4; side++)
+    {
+        addFrames(run, 100, 0.02, 0.02);
+        addFrames(run, 20, -turnSign * turnStep, turnSign * turnStep);
+    }
+    run.start = {0, 0, 0};
+    run.end = {0, 0, 0};
+    return run;
+}
+
+/**
+ * @brief Record a 4m straight run, needed to fix the overall scale since squares end where they
+ * started
+ *
+ */
+CalibrationRun straightRun()
+{
+    CalibrationRun run;
+    addFrames(run, 200, 0.02, 0.02);
+    run.start = {0, 0, 0};
+    run.end = {4, 0, 0};
+    return run;
+}
+
+/**
+ * @brief Runs of a robot with the true geometry and the nominal geometry as a starting point
+ *
+ */
+CalibrationProblem squareProblem()
+{
+    CalibrationProblem problem;
+    problem.runs = {squareRun(1), squareRun(-1), straightRun()};
+    problem.gearRatio = GEAR;
+    problem.wheelCircumference = NOMINAL_CIRCUMFERENCE;
+    problem.wheelBase = NOMINAL_WHEEL_BASE;
+    return problem;
+}
+
+// Check that the geometry the runs were driven with is recovered from square runs in both
+// directions
+TEST(CalibrationTests, SquareRuns)
+{
+    auto calibration = calibrateWheelGeometry(squareProblem());
+
+    EXPECT_NEAR(TRUE_LEFT_CIRCUMFERENCE, calibration.leftCircumference, 0.0005);
+    EXPECT_NEAR(TRUE_RIGHT_CIRCUMFERENCE, calibration.rightCircumference, 0.0005);
+    EXPECT_NEAR(TRUE_WHEEL_BASE, calibration.wheelBase, 0.0005);
+    EXPECT_LT(calibration.residual, 0.001);
+}
+
+// Check that without runs the starting geometry is returned
+TEST(CalibrationTests, NoRuns)
+{
+    CalibrationProblem problem = squareProblem();
+    problem.runs.clear();
+    auto calibration = calibrateWheelGeometry(problem);
+
+    ASSERT_EQ(NOMINAL_CIRCUMFERENCE, calibration.leftCircumference);
+    ASSERT_EQ(NOMINAL_WHEEL_BASE, calibration.wheelBase);
+    ASSERT_EQ(0, calibration.iterations);
+}
+
+// Check that calibrating a fleet in parallel matches calibrating each robot on its own
+TEST(CalibrationTests, Fleet)
+{
+    std::vector<CalibrationProblem> problems(8, squareProblem());
+    auto single = calibrateWheelGeometry(problems[0]);
+    auto results = calibrateFleet(problems, 4);
+
+    ASSERT_EQ(problems.size(), results.size());
+    for (const auto& result : results)
+    {
+        ASSERT_EQ(single.leftCircumference, result.leftCircumference);
+        ASSERT_EQ(single.rightCircumference, result.rightCircumference);
+        ASSERT_EQ(single.wheelBase, result.wheelBase);
+    }
+}
+
+/**
+ * @brief Turn a run back into the raw readings an edge device would have logged, with the left
+ * reading decreasing when driving forward
+ *
+ */
+std::vector<EncoderFrame> recordLog(const CalibrationRun& run)
+{
+    std::vector<EncoderFrame> frames;
+    float left = 200;
+    float right = 100;
+    frames.push_back({left, right, 0});
+    for (size_t frame = 0; frame < run.leftDegrees.size(); frame++)
+    {
+        left = fmodf(left - run.leftDegrees[frame] + THREE_SIXTY, THREE_SIXTY);
+        right = fmodf(right + run.rightDegrees[frame] + THREE_SIXTY, THREE_SIXTY);
+        frames.push_back({left, right, static_cast<uint16_t>((frame + 1) * 20)});
+    }
+    return frames;
+}
+
+// Check that runs built from raw encoder logs unwrap rollovers and directions like the processor
+TEST(CalibrationTests, EncoderLog)
+{
+    CalibrationProblem problem = squareProblem();
+    CalibrationProblem logged = problem;
+    for (auto& run : logged.runs)
+    {
+        auto frames = recordLog(run);
+        run = makeCalibrationRun(frames.data(), frames.size(), 180.0, true, false, run.start,
+                                 run.end);
+    }
+
+    for (size_t index = 0; index < problem.runs.size(); index++)
+    {
+        const auto& original = problem.runs[index];
+        const auto& run = logged.runs[index];
+        ASSERT_EQ(original.leftDegrees.size(), run.leftDegrees.size());
+        for (size_t frame = 0; frame < run.leftDegrees.size(); frame++)
+        {
+            ASSERT_NEAR(original.leftDegrees[frame], run.leftDegrees[frame], 0.001);
+            ASSERT_NEAR(original.rightDegrees[frame], run.rightDegrees[frame], 0.001);
+        }
+    }
+
+    auto calibration = calibrateWheelGeometry(logged);
+    EXPECT_NEAR(TRUE_LEFT_CIRCUMFERENCE, calibration.leftCircumference, 0.0005);
+    EXPECT_NEAR(TRUE_RIGHT_CIRCUMFERENCE, calibration.rightCircumference, 0.0005);
+    EXPECT_NEAR(TRUE_WHEEL_BASE, calibration.wheelBase, 0.0005);
+
+    CalibrationRun empty = makeCalibrationRun(nullptr, 0, 180.0, true, false, {}, {});
+    ASSERT_TRUE(empty.leftDegrees.empty());
+}
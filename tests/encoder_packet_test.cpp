@@ -0,0 +1,193 @@
+#include "encoder_to_odom/encoder_packet.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Encode a list of frames back to back as the edge device would send them
+ *
+ */
+std::vector<uint8_t> encodeFrames(const std::vector<EncoderFrame>& frames)
+{
+    std::vector<uint8_t> bytes;
+    for (const auto& frame : frames)
+    {
+        uint8_t packet[ENCODER_PACKET_MAX_SIZE];
+        size_t size = encodeEncoderPacket(frame, packet);
+        bytes.insert(bytes.end(), packet, packet + size);
+    }
+    return bytes;
+}
+
+// Frames with zero bytes in every field to exercise the COBS encoding
+const std::vector<EncoderFrame> FRAMES = {
+    {0.0f, 0.0f, 0}, {120.0f, 300.0f, 1000}, {359.5f, 0.25f, 256}, {-1.0f, 2.0f, 65535}};
+
+// Check the CRC matches the published check value
+TEST(EncoderPacketTests, Crc)
+{
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    ASSERT_EQ(0x29B1, crc16(check, sizeof(check)));
+}
+
+// Check frames survive encoding and decoding one byte at a time
+TEST(EncoderPacketTests, RoundTrip)
+{
+    auto bytes = encodeFrames(FRAMES);
+    EncoderPacketDecoder decoder;
+    std::vector<EncoderFrame> decoded;
+    for (size_t index = 0; index < bytes.size(); index++)
+    {
+        EncoderFrame frame;
+        if (decoder.push(bytes[index], frame))
+        {
+            decoded.push_back(frame);
+        }
+    }
+    // The only zero bytes are the delimiters
+    ASSERT_EQ(FRAMES.size(), static_cast<size_t>(std::count(bytes.begin(), bytes.end(), 0)));
+
+    ASSERT_EQ(FRAMES.size(), decoded.size());
+    for (size_t index = 0; index < FRAMES.size(); index++)
+    {
+        ASSERT_EQ(FRAMES[index].left, decoded[index].left);
+        ASSERT_EQ(FRAMES[index].right, decoded[index].right);
+        ASSERT_EQ(FRAMES[index].timestamp, decoded[index].timestamp);
+    }
+    ASSERT_EQ(FRAMES.size(), decoder.getCounters().frames);
+}
+
+// Check decoding resyncs after starting mid packet, corruption and line noise
+TEST(EncoderPacketTests, Resync)
+{
+    auto bytes = encodeFrames(FRAMES);
+    std::vector<uint8_t> stream(bytes.begin() + 5, bytes.end()); // Opened mid packet
+    auto corrupt = encodeFrames({FRAMES[1]});
+    corrupt[1] ^= 0x10; // Low byte of the timestamp
+    stream.insert(stream.end(), corrupt.begin(), corrupt.end());
+    stream.insert(stream.end(), 40, 0x55); // Noise longer than any packet
+    stream.push_back(0);
+    auto tail = encodeFrames({FRAMES[2]});
+    stream.insert(stream.end(), tail.begin(), tail.end());
+
+    EncoderPacketDecoder decoder;
+    EncoderFrame frames[8];
+    size_t consumed;
+    size_t count = decoder.decode(stream.data(), stream.size(), frames, 8, consumed);
+
+    ASSERT_EQ(stream.size(), consumed);
+    ASSERT_EQ(FRAMES.size(), count);
+    ASSERT_EQ(FRAMES[1].timestamp, frames[0].timestamp);
+    ASSERT_EQ(FRAMES[2].left, frames[FRAMES.size() - 1].left);
+    auto counters = decoder.getCounters();
+    ASSERT_EQ(1u, counters.crcErrors);
+    ASSERT_EQ(2u, counters.framingErrors);
+}
+
+// Check decode stops once the frame array is full and picks up where it left off
+TEST(EncoderPacketTests, PartialDecode)
+{
+    auto bytes = encodeFrames(FRAMES);
+    EncoderPacketDecoder decoder;
+    EncoderFrame frames[2];
+    size_t consumed;
+    ASSERT_EQ(2u, decoder.decode(bytes.data(), bytes.size(), frames, 2, consumed));
+    ASSERT_EQ(FRAMES[1].right, frames[1].right);
+
+    size_t rest = bytes.size() - consumed;
+    ASSERT_EQ(2u, decoder.decode(bytes.data() + consumed, rest, frames, 2, consumed));
+    ASSERT_EQ(rest, consumed);
+    ASSERT_EQ(FRAMES[3].timestamp, frames[1].timestamp);
+}
+
+// Check decoded frames drive the processor the same as passing readings in directly
+TEST(EncoderPacketTests, FeedProcessor)
+{
+    std::vector<EncoderFrame> frames;
+    for (int frame = 0; frame < 10; frame++)
+    {
+        frames.push_back({10.0f * frame, 12.0f * frame, static_cast<uint16_t>(100 * frame)});
+    }
+    auto bytes = encodeFrames(frames);
+
+    OdometryProcessor decoded(1.0f, 0.5f, 2.0f, 180.0f);
+    EncoderPacketDecoder decoder;
+    ASSERT_EQ(frames.size(), decoder.decode(bytes.data(), bytes.size(), decoded));
+
+    OdometryProcessor direct(1.0f, 0.5f, 2.0f, 180.0f);
+    for (const auto& frame : frames)
+    {
+        direct.updateCurrentValue(Motor::LEFT, frame.left);
+        direct.updateCurrentValue(Motor::RIGHT, frame.right);
+        direct.updateTimestamp(frame.timestamp);
+        direct.processData();
+    }
+
+    ASSERT_FLOAT_EQ(direct.getPosition().x, decoded.getPosition().x);
+    ASSERT_FLOAT_EQ(direct.getPosition().theta, decoded.getPosition().theta);
+    ASSERT_FLOAT_EQ(direct.getVelocity().linearX, decoded.getVelocity().linearX);
+}
+
+#if defined(__unix__)
+// Check frames written to a pseudo terminal in odd sized chunks decode on the other side
+TEST(EncoderPacketTests, PseudoTerminal)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(0, grantpt(master));
+    ASSERT_EQ(0, unlockpt(master));
+    int port = open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    ASSERT_GE(port, 0);
+    termios settings;
+    tcgetattr(port, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(port, TCSANOW, &settings);
+
+    std::vector<EncoderFrame> frames;
+    for (int frame = 0; frame < 50; frame++)
+    {
+        frames.push_back({1.5f * frame, -2.5f * frame, static_cast<uint16_t>(frame * 1000)});
+    }
+    auto bytes = encodeFrames(frames);
+    for (size_t offset = 0; offset < bytes.size(); offset += 7)
+    {
+        size_t chunk = std::min<size_t>(7, bytes.size() - offset);
+        ASSERT_EQ(static_cast<ssize_t>(chunk), write(master, bytes.data() + offset, chunk));
+    }
+
+    EncoderPacketDecoder decoder;
+    std::vector<EncoderFrame> decoded;
+    uint8_t buffer[32];
+    for (int attempt = 0; attempt < 1000 && decoded.size() < frames.size(); attempt++)
+    {
+        ssize_t size = read(port, buffer, sizeof(buffer));
+        if (size <= 0)
+        {
+            usleep(1000);
+            continue;
+        }
+        EncoderFrame decodedFrames[4];
+        size_t consumed = 0;
+        for (size_t offset = 0; offset < static_cast<size_t>(size); offset += consumed)
+        {
+            size_t count = decoder.decode(buffer + offset, size - offset, decodedFrames, 4,
+                                          consumed);
+            decoded.insert(decoded.end(), decodedFrames, decodedFrames + count);
+        }
+    }
+    close(port);
+    close(master);
+
+    ASSERT_EQ(frames.size(), decoded.size());
+    ASSERT_EQ(frames[49].right, decoded[49].right);
+    ASSERT_EQ(frames[49].timestamp, decoded[49].timestamp);
+    ASSERT_EQ(0u, decoder.getCounters().crcErrors + decoder.getCounters().framingErrors);
+}
+#endif
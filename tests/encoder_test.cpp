@@ -1,5 +1,9 @@
 #include "encoder_to_odom/odometry.h"
+#include "encoder_to_odom/geometry_mailbox.h"
+#include "encoder_to_odom/pose_math.h"
 #include <gtest/gtest.h>
+#include <thread>
+#include <type_traits>
 
 // Default test values
 constexpr float WHEEL_CIRCUMFERENCE = 1.0373;
@@ -250,6 +254,704 @@ TEST(FrameTests, Velocity)
     ASSERT_EQ(2 * deltaAngle, calculatedVelocity.angularZ); // Rad / sec
 }
 
+/**
+ * @brief Send one frame of readings one second after the last one
+ *
+ */
+void sendFrame(Tester& processor, float left, float right)
+{
+    processor.updateCurrentValue(Motor::LEFT, left);
+    processor.updateCurrentValue(Motor::RIGHT, right);
+    processor.startTime += 1000;
+    processor.updateTimestamp(processor.startTime);
+    processor.processData();
+}
+
+// Check that a glitched reading is thrown out and the next frame measures from the last good one
+TEST(FrameTests, RejectGlitch)
+{
+    auto processor = Tester();
+    ValidationConfig config;
+    config.maxWheelSpeed = 0.15;
+    processor.enableFrameValidation(config);
+    processor.settleReadings(120, 300);
+
+    sendFrame(processor, 110, 310);
+    auto position = processor.getPosition();
+
+    // Right encoder read glitches by half a turn
+    sendFrame(processor, 100, 130);
+    ASSERT_EQ(position.x, processor.getPosition().x);
+    ASSERT_EQ(1u, processor.getValidationCounters().rejectedFrames);
+    ASSERT_EQ(1u, processor.getValidationCounters().speedViolations);
+
+    sendFrame(processor, 100, 320);
+    ASSERT_EQ(-20.0, processor.getTotalDegreesTraveled(Motor::LEFT));
+    ASSERT_EQ(20.0, processor.getTotalDegreesTraveled(Motor::RIGHT));
+    ASSERT_EQ(3u, processor.getValidationCounters().framesChecked);
+}
+
+// Check that a wheel moving faster then possible is limited to the max speed
+TEST(FrameTests, ClampSpeed)
+{
+    auto processor = Tester();
+    ValidationConfig config;
+    config.maxWheelSpeed = 0.05;
+    config.action = GlitchAction::CLAMP;
+    processor.enableFrameValidation(config);
+    processor.settleReadings(120, 300);
+
+    sendFrame(processor, 110, 360);
+
+    float limit = 0.05 * THREE_SIXTY * GEAR_RATIO / WHEEL_CIRCUMFERENCE;
+    ASSERT_NEAR(limit, processor.getDegreesTraveledInFrame(Motor::RIGHT), 0.001);
+    ASSERT_EQ(-10.0, processor.getDegreesTraveledInFrame(Motor::LEFT));
+    ASSERT_NEAR(limit, processor.getTotalDegreesTraveled(Motor::RIGHT), 0.001);
+    ASSERT_EQ(1u, processor.getValidationCounters().clampedFrames);
+}
+
+// Check that the acceleration limit does not hold back a robot that is already moving when
+// validation starts
+TEST(FrameTests, AccelerationLimitMovingStart)
+{
+    auto processor = Tester();
+    processor.setSettlePolicy({SettlePolicy::IMMEDIATE});
+    ValidationConfig config;
+    config.maxWheelAcceleration = 2.0;
+    processor.enableFrameValidation(config);
+
+    // Both wheels turn forward 3 degrees every 20ms from the first frame
+    for (int frame = 0; frame < 40; frame++)
+    {
+        processor.processFrame({fmodf(THREE_SIXTY - frame * 3.0f, THREE_SIXTY), frame * 3.0f,
+                                static_cast<uint16_t>(frame * 20)});
+    }
+
+    ASSERT_EQ(0u, processor.getValidationCounters().rejectedFrames);
+    float expected = 39 * 3.0f * WHEEL_CIRCUMFERENCE / GEAR_RATIO / THREE_SIXTY;
+    ASSERT_NEAR(expected, processor.getPosition().x, 0.001);
+}
+
+// Check that a glitch lasting more then GLITCH_RESYNC_FRAMES frames is taken as real motion
+TEST(FrameTests, RejectResync)
+{
+    auto processor = Tester();
+    ValidationConfig config;
+    config.maxWheelAcceleration = 2.0;
+    processor.enableFrameValidation(config);
+    processor.settleReadings(120, 300);
+    sendFrame(processor, 120, 300);
+
+    // The robot is bumped from standstill to 1m/s, so each frame is past the acceleration limit
+    // until the resync accepts the whole move since the last good frame
+    float step = THREE_SIXTY * GEAR_RATIO / WHEEL_CIRCUMFERENCE / 50.0f;
+    for (int frame = 1; frame <= GLITCH_RESYNC_FRAMES + 1; frame++)
+    {
+        processor.updateCurrentValue(Motor::LEFT, fmodf(120 - frame * step + 720, THREE_SIXTY));
+        processor.updateCurrentValue(Motor::RIGHT, fmodf(300 + frame * step, THREE_SIXTY));
+        processor.startTime += 20;
+        processor.updateTimestamp(processor.startTime);
+        processor.processData();
+    }
+
+    ASSERT_EQ(static_cast<uint32_t>(GLITCH_RESYNC_FRAMES),
+              processor.getValidationCounters().rejectedFrames);
+    ASSERT_NEAR((GLITCH_RESYNC_FRAMES + 1) * 0.02f, processor.getPosition().x, 0.001);
+}
+
+// Check that rollovers are resolved from the wheel speed when a wheel turns more then half a turn
+// between readings
+TEST(FrameTests, AdaptiveRollover)
+{
+    auto processor = Tester();
+    processor.enableAdaptiveRollover(4.0);
+    processor.settleReadings(120, 300);
+
+    // Right wheel speeds up until it turns most of a revolution every 100ms
+    float steps[] = {60, 120, 170, 220, 250, 250};
+    float right = 300;
+    float total = 0;
+    for (auto step : steps)
+    {
+        right = fmodf(right + step, THREE_SIXTY);
+        total += step;
+        processor.updateCurrentValue(Motor::LEFT, 120);
+        processor.updateCurrentValue(Motor::RIGHT, right);
+        processor.startTime += 100;
+        processor.updateTimestamp(processor.startTime);
+        processor.processData();
+    }
+
+    ASSERT_NEAR(total, processor.getTotalDegreesTraveled(Motor::RIGHT), 0.001);
+}
+
+// Check that the immediate settle policy uses the very first frame
+TEST(SettleTests, Immediate)
+{
+    auto processor = Tester();
+    processor.setSettlePolicy({SettlePolicy::IMMEDIATE});
+
+    // A boot reading far from 0 is where the wheel starts, not a move
+    processor.updateCurrentValue(Motor::LEFT, 250);
+    processor.updateCurrentValue(Motor::RIGHT, 10);
+    processor.processData();
+
+    ASSERT_TRUE(processor.isSettled());
+    ASSERT_EQ(0.0, processor.getTotalDegreesTraveled(Motor::LEFT));
+    ASSERT_EQ(0.0, processor.getTotalDegreesTraveled(Motor::RIGHT));
+
+    processor.updateCurrentValue(Motor::LEFT, 255);
+    processor.updateCurrentValue(Motor::RIGHT, 30);
+    processor.processData();
+
+    ASSERT_EQ(5.0, processor.getTotalDegreesTraveled(Motor::LEFT));
+    ASSERT_EQ(20.0, processor.getTotalDegreesTraveled(Motor::RIGHT));
+}
+
+// Check that the variance settle policy waits for the readings to stop jumping around
+TEST(SettleTests, Variance)
+{
+    auto processor = Tester();
+    processor.setSettlePolicy({SettlePolicy::VARIANCE_THRESHOLD, 0, 1.0});
+
+    // Noisy boot readings
+    float noisy[] = {10, 40, 5, 60, 20, 80};
+    for (auto value : noisy)
+    {
+        processor.updateCurrentValue(Motor::LEFT, value);
+        processor.updateCurrentValue(Motor::RIGHT, value);
+        processor.processData();
+        ASSERT_FALSE(processor.isSettled());
+    }
+
+    // Readings that hold still, the first of these still jumps from the last noisy one
+    for (int i = 0; i <= SETTLE_WINDOW; i++)
+    {
+        processor.updateCurrentValue(Motor::LEFT, 100);
+        processor.updateCurrentValue(Motor::RIGHT, 200);
+        processor.processData();
+    }
+    ASSERT_TRUE(processor.isSettled());
+    ASSERT_EQ(0.0, processor.getTotalDegreesTraveled(Motor::RIGHT));
+
+    processor.updateCurrentValue(Motor::LEFT, 100);
+    processor.updateCurrentValue(Motor::RIGHT, 230);
+    processor.processData();
+    ASSERT_EQ(30.0, processor.getTotalDegreesTraveled(Motor::RIGHT));
+}
+
+// Check that a wheel that did not report in a frame is not counted as moving again
+TEST(FrameTests, PartialFrame)
+{
+    auto processor = Tester();
+
+    float leftEncoderReading = 120;
+    float rightEncoderReading = 50;
+    processor.settleReadings(leftEncoderReading, rightEncoderReading);
+
+    processor.updateCurrentValue(Motor::LEFT, 100);
+    processor.updateCurrentValue(Motor::RIGHT, 70);
+    processor.processData();
+
+    // Only the left wheel reports, twice
+    processor.updateCurrentValue(Motor::LEFT, 90);
+    processor.updateCurrentValue(Motor::LEFT, 80);
+    processor.processData();
+
+    ASSERT_EQ(-20.0, processor.getDegreesTraveledInFrame(Motor::LEFT));
+    ASSERT_EQ(0.0, processor.getDegreesTraveledInFrame(Motor::RIGHT));
+    ASSERT_EQ(-40.0, processor.getTotalDegreesTraveled(Motor::LEFT));
+    ASSERT_EQ(20.0, processor.getTotalDegreesTraveled(Motor::RIGHT));
+}
+
+// Check that event driven updates move the pose on every wheel reading and drive straight when
+// the wheels report at different times
+TEST(FrameTests, EventDriven)
+{
+    auto processor = Tester();
+    processor.setSettlePolicy({SettlePolicy::FIXED_COUNT, 2});
+
+    // Right wheel is sampled 5ms after the left wheel, both move 10 degrees every 10ms
+    processor.processWheelUpdate(Motor::LEFT, 200, 0);
+    processor.processWheelUpdate(Motor::RIGHT, 100, 5);
+
+    float theta = 0;
+    float x = 0;
+    for (int i = 1; i <= 10; i++)
+    {
+        processor.processWheelUpdate(Motor::LEFT, 200 - 10 * i, 10 * i);
+        ASSERT_GT(processor.getPosition().x, x);
+        x = processor.getPosition().x;
+
+        processor.processWheelUpdate(Motor::RIGHT, 100 + 10 * i, 10 * i + 5);
+        ASSERT_GT(processor.getPosition().x, x);
+        x = processor.getPosition().x;
+
+        // Once both wheels have a rate the heading holds steady
+        if (i > 2)
+        {
+            ASSERT_NEAR(theta, processor.getPosition().theta, 0.0001);
+        }
+        theta = processor.getPosition().theta;
+    }
+
+    ASSERT_EQ(-100.0, processor.getTotalDegreesTraveled(Motor::LEFT));
+    ASSERT_EQ(100.0, processor.getTotalDegreesTraveled(Motor::RIGHT));
+}
+
+// Check wheels reporting in the same millisecond move the pose without breaking the velocity
+TEST(FrameTests, EventDrivenSameTimestamp)
+{
+    auto processor = Tester();
+    processor.setSettlePolicy({SettlePolicy::FIXED_COUNT, 2});
+    processor.processWheelUpdate(Motor::LEFT, 200, 0);
+    processor.processWheelUpdate(Motor::RIGHT, 100, 0);
+
+    for (int i = 1; i <= 5; i++)
+    {
+        processor.processWheelUpdate(Motor::LEFT, 200 - 10 * i, 10 * i);
+        auto velocity = processor.getVelocity();
+        float x = processor.getPosition().x;
+
+        processor.processWheelUpdate(Motor::RIGHT, 100 + 10 * i, 10 * i);
+        ASSERT_TRUE(std::isfinite(processor.getVelocity().linearX));
+        ASSERT_TRUE(std::isfinite(processor.getVelocity().angularZ));
+        ASSERT_EQ(velocity.linearX, processor.getVelocity().linearX);
+        ASSERT_GE(processor.getPosition().x, x);
+    }
+    ASSERT_EQ(50.0, processor.getTotalDegreesTraveled(Motor::RIGHT));
+    ASSERT_GT(processor.getVelocity().linearX, 0.0);
+}
+
+/**
+ * @brief Accelerate straight ahead with the right wheel sampled a few ms after the left one
+ *
+ * @param mode How the processor aligns the wheels
+ * @return float heading at the end of the run, should be 0
+ */
+float accelerateWithSkew(AlignmentMode mode)
+{
+    auto processor = Tester();
+    processor.setSettlePolicy({SettlePolicy::FIXED_COUNT, 1});
+    processor.setAlignmentMode(mode);
+
+    // Both wheels follow 0.004 * t^2 degrees
+    auto wheelDegrees = [](int time) { return 0.004f * time * time; };
+    constexpr int SKEW = 5;
+
+    for (int time = 0; time <= 400; time += 20)
+    {
+        float left = fmodf(200.0f - wheelDegrees(time) + 3600.0f, THREE_SIXTY);
+        float right = fmodf(100.0f + wheelDegrees(time + SKEW), THREE_SIXTY);
+        processor.updateCurrentValue(Motor::LEFT, left, time);
+        processor.updateCurrentValue(Motor::RIGHT, right, time + SKEW);
+        processor.processData();
+    }
+    return processor.getPosition().theta;
+}
+
+// Check that aligning the wheels in time removes the heading bias caused by sampling skew
+TEST(FrameTests, Alignment)
+{
+    float unaligned = fabsf(accelerateWithSkew(AlignmentMode::NONE));
+    float linear = fabsf(accelerateWithSkew(AlignmentMode::LINEAR));
+    float cubic = fabsf(accelerateWithSkew(AlignmentMode::CUBIC));
+
+    ASSERT_GT(unaligned, 0.02);
+    ASSERT_LT(linear, unaligned / 20);
+    ASSERT_LT(cubic, linear);
+}
+
+// Check cubic alignment survives a wheel reporting twice with the same timestamp
+TEST(FrameTests, CubicRepeatedTimestamp)
+{
+    auto processor = Tester();
+    processor.setSettlePolicy({SettlePolicy::FIXED_COUNT, 1});
+    processor.setAlignmentMode(AlignmentMode::CUBIC);
+
+    int times[] = {0, 20, 40, 40, 60, 80, 100, 120};
+    for (int frame = 0; frame < 8; frame++)
+    {
+        processor.updateCurrentValue(Motor::LEFT, 200.0f - 10.0f * frame, times[frame]);
+        processor.updateCurrentValue(Motor::RIGHT, 100.0f + 10.0f * frame, times[frame] + 5);
+        processor.processData();
+        ASSERT_TRUE(std::isfinite(processor.getPosition().x));
+        ASSERT_TRUE(std::isfinite(processor.getPosition().theta));
+    }
+    ASSERT_GT(processor.getPosition().x, 0.0);
+}
+
+// Check alignment keeps its own delta time when frames come in through processFrame
+TEST(FrameTests, AlignmentProcessFrame)
+{
+    auto processor = Tester();
+    processor.setSettlePolicy({SettlePolicy::FIXED_COUNT, 1});
+    processor.setAlignmentMode(AlignmentMode::LINEAR);
+
+    for (int frame = 0; frame <= 10; frame++)
+    {
+        processor.processFrame({fmodf(200.0f - 10.0f * frame + THREE_SIXTY, THREE_SIXTY),
+                                100.0f + 10.0f * frame, static_cast<uint16_t>(frame * 20)});
+    }
+
+    auto velocity = processor.getVelocity();
+    ASSERT_TRUE(std::isfinite(velocity.linearX));
+    ASSERT_NEAR(10.0f * WHEEL_CIRCUMFERENCE / GEAR_RATIO / THREE_SIXTY / 0.02f, velocity.linearX,
+                0.001);
+
+    Position pose;
+    ASSERT_TRUE(processor.poseAt(190, pose));
+    ASSERT_LT(pose.x, processor.getPosition().x);
+    ASSERT_GT(pose.x, 0.0);
+}
+
+// Check combined state view matches the individual getters
+TEST(TotalTests, StateView)
+{
+    static_assert(std::is_trivially_copyable<OdometryState>::value, "state must be copyable");
+
+    auto processor = Tester();
+    processor.driveFullEncoderRotation();
+
+    const OdometryProcessor& view = processor;
+    auto state = view.state();
+    ASSERT_EQ(view.getPosition().x, state.position.x);
+    ASSERT_EQ(view.getPosition().theta, state.position.theta);
+    ASSERT_EQ(view.getVelocity().linearX, state.velocity.linearX);
+    ASSERT_EQ(view.getDistance().totalDistance, state.distance.totalDistance);
+    for (auto motor : {Motor::LEFT, Motor::RIGHT})
+    {
+        ASSERT_EQ(view.getTotalDegreesTraveled(motor), state.totalDegreesTraveled[motor]);
+        ASSERT_EQ(view.getTotalMetersTraveled(motor), state.totalMetersTraveled[motor]);
+        ASSERT_EQ(view.getDegreesTraveledInFrame(motor), state.degreesTraveledInFrame[motor]);
+        ASSERT_EQ(view.getMetersTraveledInFrame(motor), state.metersTraveledInFrame[motor]);
+    }
+}
+
+// Check that past poses can be looked up by timestamp
+TEST(TotalTests, PoseHistory)
+{
+    auto processor = Tester();
+
+    processor.driveFullEncoderRotation();
+    auto latest = processor.getPosition();
+
+    // Frames were processed every second from 4000 to 7000
+    Position pose;
+    ASSERT_TRUE(processor.poseAt(processor.startTime, pose));
+    ASSERT_NEAR(latest.x, pose.x, 0.0001);
+    ASSERT_NEAR(latest.theta, pose.theta, 0.0001);
+
+    ASSERT_FALSE(processor.poseAt(processor.startTime + 1, pose));
+    ASSERT_FALSE(processor.poseAt(processor.startTime - 5000, pose));
+
+    // Half way between two frames is on the arc between them
+    Position before;
+    Position after;
+    ASSERT_TRUE(processor.poseAt(5000, before));
+    ASSERT_TRUE(processor.poseAt(6000, after));
+    ASSERT_TRUE(processor.poseAt(5500, pose));
+    auto expected = interpolatePose(before, after, 0.5);
+    ASSERT_NEAR(expected.x, pose.x, 0.0001);
+    ASSERT_NEAR(expected.y, pose.y, 0.0001);
+    ASSERT_NEAR(expected.theta, pose.theta, 0.0001);
+
+    Position transform;
+    ASSERT_TRUE(processor.relativeTransform(5000, 6000, transform));
+    auto composed = composePose(before, transform);
+    ASSERT_NEAR(after.x, composed.x, 0.0001);
+    ASSERT_NEAR(after.y, composed.y, 0.0001);
+    ASSERT_NEAR(after.theta, composed.theta, 0.0001);
+}
+
+// Check that the pose is extrapolated forward with the current velocity
+TEST(TotalTests, PredictPose)
+{
+    auto processor = Tester();
+
+    processor.driveStraightOneEncoderRotation();
+    auto position = processor.getPosition();
+    auto velocity = processor.getVelocity();
+    ASSERT_GT(velocity.linearX, 0.0);
+
+    auto predicted = processor.predictPose(0.0);
+    ASSERT_NEAR(position.x, predicted.x, 0.0001);
+
+    // Driving straight, so the prediction moves straight ahead
+    predicted = processor.predictPose(0.5);
+    ASSERT_NEAR(position.x + velocity.linearX * 0.5, predicted.x, 0.0001);
+    ASSERT_NEAR(position.y, predicted.y, 0.0001);
+    ASSERT_NEAR(position.theta, predicted.theta, 0.0001);
+
+    // Without velocity the latest pose is returned
+    auto stopped = Tester();
+    predicted = stopped.predictPose(0.5);
+    ASSERT_EQ(0.0, predicted.x);
+}
+
+// Check that the pose covariance grows with the distance the wheels travel
+TEST(TotalTests, Covariance)
+{
+    auto processor = Tester();
+    constexpr float NOISE = 0.01;
+    processor.enableCovariance(NOISE, NOISE);
+
+    processor.driveStraightOneEncoderRotation();
+    auto covariance = processor.getCovariance().values;
+
+    // Driving straight ahead each frame adds a quarter of the wheel variance to x
+    float wheelMeters = WHEEL_CIRCUMFERENCE / GEAR_RATIO;
+    ASSERT_NEAR(NOISE * wheelMeters / 2, covariance[0], 0.00001);
+
+    // Heading uncertainty turns into sideways uncertainty
+    ASSERT_GT(covariance[4], 0.0);
+    ASSERT_GT(covariance[8], 0.0);
+
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            ASSERT_NEAR(covariance[row * 3 + col], covariance[col * 3 + row], 0.000001);
+        }
+    }
+
+    // Nothing is tracked unless enabled
+    auto untracked = Tester();
+    untracked.driveStraightOneEncoderRotation();
+    ASSERT_EQ(0.0, untracked.getCovariance().values[0]);
+}
+
+// Check that the gyro heading is blended with the wheel heading and its bias is removed while
+// standing still
+TEST(TotalTests, GyroFusion)
+{
+    auto processor = Tester();
+    processor.enableGyroFusion(0.75);
+    processor.settleReadings(120, 300);
+
+    // Gyro reads 0.1 rad/s while the wheels do not move, gyro samples every 100ms
+    float left = 120;
+    float right = 300;
+    for (int frame = 0; frame < 60; frame++)
+    {
+        for (int sample = 0; sample < 10; sample++)
+        {
+            processor.updateGyro(0.1, processor.startTime + sample * 100);
+        }
+        processor.updateCurrentValue(Motor::LEFT, left);
+        processor.updateCurrentValue(Motor::RIGHT, right);
+        processor.startTime += 1000;
+        processor.updateTimestamp(processor.startTime);
+        processor.processData();
+    }
+    ASSERT_EQ(0.0, processor.getPosition().theta);
+
+    // Right wheel slips 10 degrees each frame while the gyro (still biased) says it drives straight
+    for (int frame = 0; frame < 4; frame++)
+    {
+        for (int sample = 0; sample < 10; sample++)
+        {
+            processor.updateGyro(0.1, processor.startTime + sample * 100);
+        }
+        left -= 10;
+        right += 20;
+        processor.updateCurrentValue(Motor::LEFT, left);
+        processor.updateCurrentValue(Motor::RIGHT, right);
+        processor.startTime += 1000;
+        processor.updateTimestamp(processor.startTime);
+        processor.processData();
+    }
+
+    // Only a quarter of the wheel heading is kept
+    float wheelAngle = asinf(10 / THREE_SIXTY / GEAR_RATIO * WHEEL_CIRCUMFERENCE / WHEEL_BASE);
+    ASSERT_NEAR(4 * 0.25 * wheelAngle, processor.getPosition().theta, 0.001);
+}
+
+// Check gyro turning before fusion is enabled and the processor settled is not applied
+TEST(TotalTests, GyroFusionStartsClean)
+{
+    auto processor = Tester();
+    for (int sample = 0; sample < 50; sample++)
+    {
+        processor.updateGyro(1.0, sample * 100);
+    }
+    processor.enableGyroFusion(1.0);
+    // Settling frames are one second apart, the gyro turns the whole time
+    for (int sample = 0; sample < SETTLE_READINGS * 10; sample++)
+    {
+        processor.updateGyro(1.0, sample * 100);
+    }
+    processor.settleReadings(120, 300);
+
+    // Straight drive with the gyro now still
+    for (int sample = 0; sample < 10; sample++)
+    {
+        processor.updateGyro(0.0, processor.startTime + sample * 100);
+    }
+    sendFrame(processor, 110, 310);
+    ASSERT_EQ(0.0, processor.getPosition().theta);
+}
+
+// Check the gyro bias is still learned while encoder jitter moves the wheels slightly
+TEST(TotalTests, GyroBiasWithJitter)
+{
+    auto processor = Tester();
+    processor.enableGyroFusion(1.0);
+    processor.settleReadings(120, 300);
+
+    for (int frame = 0; frame < 60; frame++)
+    {
+        for (int sample = 0; sample < 10; sample++)
+        {
+            processor.updateGyro(0.1, processor.startTime + sample * 100);
+        }
+        float jitter = frame % 2 == 0 ? 0.05 : -0.05;
+        sendFrame(processor, 120 + jitter, 300 - jitter);
+    }
+
+    // Drive straight, the learned bias cancels the gyro reading
+    float left = 120;
+    float right = 300;
+    for (int frame = 0; frame < 4; frame++)
+    {
+        for (int sample = 0; sample < 10; sample++)
+        {
+            processor.updateGyro(0.1, processor.startTime + sample * 100);
+        }
+        left -= 10;
+        right += 10;
+        sendFrame(processor, left, right);
+    }
+    ASSERT_NEAR(0.0, processor.getPosition().theta, 0.002);
+}
+
+// Check frames without a gyro sample keep the full wheel heading when fusion is enabled
+TEST(TotalTests, GyroFusionWithoutSamples)
+{
+    auto fused = Tester();
+    fused.enableGyroFusion(0.75);
+    auto wheelsOnly = Tester();
+    for (auto* processor : {&fused, &wheelsOnly})
+    {
+        processor->settleReadings(120, 300);
+        processor->updateCurrentValue(Motor::LEFT, 110);
+        processor->updateCurrentValue(Motor::RIGHT, 320);
+        processor->startTime += 1000;
+        processor->updateTimestamp(processor->startTime);
+        processor->processData();
+    }
+
+    ASSERT_NE(0.0, wheelsOnly.getPosition().theta);
+    ASSERT_EQ(wheelsOnly.getPosition().theta, fused.getPosition().theta);
+    ASSERT_EQ(wheelsOnly.getVelocity().angularZ, fused.getVelocity().angularZ);
+}
+
+// Check that wheels of different sizes and gearing are each converted with their own geometry
+TEST(TotalTests, AsymmetricWheels)
+{
+    WheelGeometry left = {WHEEL_CIRCUMFERENCE * 1.005f, GEAR_RATIO};
+    WheelGeometry right = {WHEEL_CIRCUMFERENCE, GEAR_RATIO * 2};
+    OdometryProcessor processor(left, right, WHEEL_BASE, ROLLOVER);
+    processor.setSettlePolicy({SettlePolicy::IMMEDIATE});
+
+    processor.updateCurrentValue(Motor::LEFT, 45);
+    processor.updateCurrentValue(Motor::RIGHT, 45);
+    processor.processData();
+    processor.updateCurrentValue(Motor::LEFT, 135);
+    processor.updateCurrentValue(Motor::RIGHT, 135);
+    processor.processData();
+
+    ASSERT_NEAR(left.circumference / 4 / GEAR_RATIO,
+                processor.getTotalMetersTraveled(Motor::LEFT), 0.00001);
+    ASSERT_NEAR(right.circumference / 8 / GEAR_RATIO,
+                processor.getTotalMetersTraveled(Motor::RIGHT), 0.00001);
+
+    ASSERT_EQ(left.circumference, processor.getWheelCircumference(Motor::LEFT));
+    ASSERT_EQ(GEAR_RATIO * 2, processor.getGearRatio(Motor::RIGHT));
+    ASSERT_NEAR(WHEEL_CIRCUMFERENCE * 1.0025f, processor.getWheelCircumference(), 0.00001);
+    ASSERT_EQ(WHEEL_BASE, processor.getWheelBase());
+}
+
+// Check that geometry published from another thread is applied at the next frame without losing
+// the pose
+TEST(TotalTests, GeometryMailbox)
+{
+    auto processor = Tester();
+    GeometryMailbox mailbox;
+    processor.attachGeometryMailbox(&mailbox);
+
+    processor.driveStraightOneEncoderRotation();
+    auto position = processor.getPosition();
+    ASSERT_EQ(WHEEL_BASE, processor.getWheelBase());
+
+    DriveGeometry geometry = {{WHEEL_CIRCUMFERENCE * 2, GEAR_RATIO},
+                              {WHEEL_CIRCUMFERENCE * 2, GEAR_RATIO},
+                              WHEEL_BASE * 2};
+    std::thread publisher([&]() { mailbox.publish(geometry); });
+    publisher.join();
+    ASSERT_EQ(1u, mailbox.version());
+
+    // Not applied until the next frame
+    ASSERT_EQ(WHEEL_BASE, processor.getWheelBase());
+
+    processor.updateCurrentValue(Motor::LEFT, 30);
+    processor.updateCurrentValue(Motor::RIGHT, 30);
+    processor.processData();
+
+    ASSERT_EQ(WHEEL_BASE * 2, processor.getWheelBase());
+    ASSERT_NEAR(position.x + 90 / THREE_SIXTY / GEAR_RATIO * WHEEL_CIRCUMFERENCE * 2,
+                processor.getPosition().x, 0.0001);
+}
+
+// Check that frames never see a geometry mixed from two publishes
+TEST(TotalTests, GeometryMailboxConcurrent)
+{
+    auto processor = Tester();
+    GeometryMailbox mailbox;
+    processor.attachGeometryMailbox(&mailbox);
+    processor.setSettlePolicy({SettlePolicy::IMMEDIATE});
+
+    // Publish a fixed number of geometries, ending with one the processor must reach
+    constexpr int PUBLISHES = 5000;
+    constexpr float FINAL_SCALE = 9.0f;
+    std::atomic<bool> done{false};
+    std::thread publisher(
+        [&]()
+        {
+            for (int i = 1; i <= PUBLISHES; i++)
+            {
+                float scale = static_cast<float>(i % 7 + 1);
+                mailbox.publish({{scale, scale}, {scale, scale}, scale});
+            }
+            mailbox.publish({{FINAL_SCALE, FINAL_SCALE}, {FINAL_SCALE, FINAL_SCALE}, FINAL_SCALE});
+            done = true;
+        });
+
+    // Process until the last geometry is applied, every geometry seen on the way must be whole
+    bool consistent = true;
+    int applied = 0;
+    while (true)
+    {
+        bool finished = done;
+        processor.processData();
+        auto geometry = processor.getGeometry();
+        if (geometry.wheelBase != WHEEL_BASE)
+        {
+            applied++;
+            consistent &= geometry.wheelBase == geometry.leftWheel.circumference &&
+                          geometry.wheelBase == geometry.rightWheel.gearRatio;
+        }
+        if (finished && geometry.wheelBase == FINAL_SCALE)
+        {
+            break;
+        }
+    }
+    publisher.join();
+
+    ASSERT_TRUE(consistent);
+    ASSERT_GT(applied, 0);
+}
+
 // Check system calculates correct distance moved from one full rotation on encoders
 TEST(TotalTests, DeltaMetersOneEncoderRotation)
 {
@@ -0,0 +1,155 @@
+#include "encoder_to_odom/event_loop.h"
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Write a frame to the link the way the edge device would
+ *
+ */
+void sendFrame(int link, float left, float right, uint16_t timestamp)
+{
+    uint8_t packet[ENCODER_PACKET_MAX_SIZE];
+    size_t size = encodeEncoderPacket({left, right, timestamp}, packet);
+    ASSERT_EQ(static_cast<ssize_t>(size), write(link, packet, size));
+}
+
+// Check frames written to a pipe are processed and reported
+TEST(EventLoopTests, PipeFrames)
+{
+    int pipe[2];
+    ASSERT_EQ(0, ::pipe(pipe));
+    OdometryProcessor processor(1.0f, 0.5f, 1.0f, 180.0f);
+    OdometryEventLoop loop(processor);
+    ASSERT_TRUE(loop.open(pipe[0], 1000));
+    ASSERT_FALSE(loop.open(pipe[0], 1000));
+
+    std::vector<OdometryState> states;
+    loop.onFrame([&](const OdometryState& state) { states.push_back(state); });
+
+    for (int frame = 0; frame < 10; frame++)
+    {
+        sendFrame(pipe[1], 36.0f * frame, 36.0f * frame, static_cast<uint16_t>(100 * frame));
+    }
+    int frames = 0;
+    while (frames < 10)
+    {
+        int handled = loop.runOnce(1000);
+        ASSERT_GE(handled, 0);
+        frames += handled;
+    }
+
+    ASSERT_EQ(10u, states.size());
+    ASSERT_EQ(900, states.back().timestamp);
+    ASSERT_FLOAT_EQ(processor.getPosition().x, states.back().position.x);
+    ASSERT_GT(states.back().position.x, 0.0f);
+
+    // Closing the writer ends the loop
+    close(pipe[1]);
+    ASSERT_EQ(-1, loop.runOnce(1000));
+}
+
+// Check the watchdog flags stale encoders and clears once frames resume
+TEST(EventLoopTests, Watchdog)
+{
+    int pipe[2];
+    ASSERT_EQ(0, ::pipe(pipe));
+    OdometryProcessor processor(1.0f, 0.5f, 1.0f, 180.0f);
+    OdometryEventLoop loop(processor);
+    ASSERT_TRUE(loop.open(pipe[0], 20));
+
+    std::vector<bool> changes;
+    loop.onStale([&](bool stale) { changes.push_back(stale); });
+
+    sendFrame(pipe[1], 0.0f, 0.0f, 0);
+    ASSERT_EQ(1, loop.runOnce(1000));
+    ASSERT_FALSE(loop.isStale());
+
+    // Nothing arrives for longer than the timeout
+    ASSERT_EQ(0, loop.runOnce(1000));
+    ASSERT_TRUE(loop.isStale());
+
+    sendFrame(pipe[1], 1.0f, 1.0f, 100);
+    ASSERT_EQ(1, loop.runOnce(1000));
+    ASSERT_FALSE(loop.isStale());
+    ASSERT_EQ((std::vector<bool>{true, false}), changes);
+
+    close(pipe[1]);
+}
+
+// Check run() handles frames until stopped from another thread
+TEST(EventLoopTests, Stop)
+{
+    int pipe[2];
+    ASSERT_EQ(0, ::pipe(pipe));
+    OdometryProcessor processor(1.0f, 0.5f, 1.0f, 180.0f);
+    OdometryEventLoop loop(processor);
+    ASSERT_TRUE(loop.open(pipe[0], 1000));
+
+    std::atomic<int> frames{0};
+    loop.onFrame([&](const OdometryState&) { frames++; });
+    std::thread runner([&]() { loop.run(); });
+
+    for (int frame = 0; frame < 5; frame++)
+    {
+        sendFrame(pipe[1], 10.0f * frame, 10.0f * frame, static_cast<uint16_t>(100 * frame));
+    }
+    while (frames < 5)
+    {
+        std::this_thread::yield();
+    }
+    loop.stop();
+    runner.join();
+
+    ASSERT_EQ(5, frames.load());
+    ASSERT_EQ(-1, loop.runOnce(0));
+    close(pipe[1]);
+}
+
+/**
+ * @brief Count the descriptors this process has open
+ *
+ */
+int openDescriptors()
+{
+    int count = 0;
+    DIR* directory = opendir("/proc/self/fd");
+    while (readdir(directory) != nullptr)
+    {
+        count++;
+    }
+    closedir(directory);
+    return count;
+}
+
+// Check a failed open closes the descriptor and everything created for it, so it can be retried
+TEST(EventLoopTests, FailedOpen)
+{
+    OdometryProcessor processor(1.0f, 0.5f, 1.0f, 180.0f);
+    OdometryEventLoop loop(processor);
+    int before = openDescriptors();
+
+    // Regular files cannot be watched with epoll
+    std::string path = "/tmp/encoder_to_odom_link_" + std::to_string(getpid());
+    int file = ::open(path.c_str(), O_RDWR | O_CREAT, 0600);
+    ASSERT_GE(file, 0);
+    unlink(path.c_str());
+    ASSERT_FALSE(loop.open(file, 1000));
+    ASSERT_EQ(before, openDescriptors());
+
+    int pipe[2];
+    ASSERT_EQ(0, ::pipe(pipe));
+    ASSERT_FALSE(loop.open(pipe[0], 0));
+    ASSERT_EQ(-1, fcntl(pipe[0], F_GETFD));
+
+    ASSERT_EQ(0, ::pipe(pipe));
+    ASSERT_TRUE(loop.open(pipe[0], 1000));
+    close(pipe[1]);
+}
@@ -0,0 +1,139 @@
+#include "encoder_to_odom/geometry_mailbox.h"
+#include "encoder_to_odom/keyframe_index.h"
+#include "encoder_to_odom/pose_math.h"
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Recorded log of a robot driving loops, long enough for the timestamps to wrap
+ *
+ */
+std::vector<EncoderFrame> loopLog(size_t frames)
+{
+    std::vector<EncoderFrame> log;
+    float left = 0.0f;
+    float right = 0.0f;
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        left = fmodf(left + 30.0f, THREE_SIXTY);
+        right = fmodf(right + 30.0f + 6.0f * cosf(frame * 0.002f), THREE_SIXTY);
+        // Frames every 20ms with the occasional late one
+        log.push_back({left, right, static_cast<uint16_t>(frame * 20 + (frame / 7) * 3)});
+    }
+    return log;
+}
+
+OdometryProcessor loopProcessor() { return OdometryProcessor(0.4f, 0.45f, 3.0f, 180.0f); }
+
+/**
+ * @brief Replay a log from the start up to and including the last frame at or before a time
+ *
+ */
+OdometryProcessor replayTo(const std::vector<EncoderFrame>& log, int64_t time)
+{
+    auto processor = loopProcessor();
+    int64_t frameTime = 0;
+    for (size_t frame = 0; frame < log.size(); frame++)
+    {
+        if (frame > 0)
+        {
+            frameTime += OdometryProcessor::elapsedTime(log[frame].timestamp,
+                                                        log[frame - 1].timestamp);
+        }
+        if (frameTime > time)
+        {
+            break;
+        }
+        processor.processFrame(log[frame]);
+    }
+    return processor;
+}
+
+// Check lookups from a keyframe give exactly what replaying from the start gives
+TEST(KeyframeIndexTests, MatchesFullReplay)
+{
+    auto log = loopLog(20000);
+    KeyframeIndex index;
+    ASSERT_FALSE(index.build(loopProcessor(), log.data(), log.size(), 0));
+    ASSERT_TRUE(index.build(loopProcessor(), log.data(), log.size(), 500));
+    ASSERT_EQ(40u, index.getKeyframes().size());
+    // Keyframes hold the state to resume integrating, not the whole processor and its history
+    ASSERT_LT(sizeof(Keyframe), sizeof(OdometryProcessor) / 8);
+    // 20000 frames of 20ms plus 3ms every 7 frames, well past where the timestamps wrap
+    ASSERT_EQ(19999 * 20 + (19999 / 7) * 3, index.getDuration());
+
+    auto processor = loopProcessor();
+    for (int64_t time : {int64_t{0}, int64_t{65535}, int64_t{123457}, index.getDuration()})
+    {
+        ASSERT_TRUE(index.stateAt(log.data(), log.size(), time, processor));
+        auto expected = replayTo(log, time);
+        ASSERT_EQ(expected.getPosition().x, processor.getPosition().x);
+        ASSERT_EQ(expected.getPosition().theta, processor.getPosition().theta);
+        ASSERT_EQ(expected.getDistance().totalDistance, processor.getDistance().totalDistance);
+    }
+
+    // Half way between two frames is on the arc between them
+    Position pose;
+    int64_t frameTime = 20 * 1001 + (1001 / 7) * 3; // Next frame is 20ms later
+    ASSERT_TRUE(index.poseAt(log.data(), log.size(), frameTime + 10, pose));
+    auto before = replayTo(log, frameTime).getPosition();
+    auto after = replayTo(log, frameTime + 20).getPosition();
+    auto expected = interpolatePose(before, after, 0.5f);
+    ASSERT_NEAR(expected.x, pose.x, 1e-5);
+    ASSERT_NEAR(expected.y, pose.y, 1e-5);
+
+    ASSERT_FALSE(index.poseAt(log.data(), log.size(), -1, pose));
+    ASSERT_FALSE(index.poseAt(log.data(), log.size(), index.getDuration() + 1, pose));
+    ASSERT_FALSE(index.poseAt(log.data(), log.size() - 1, 0, pose));
+}
+
+// Check an index saved next to its log answers the same after loading
+TEST(KeyframeIndexTests, SaveLoad)
+{
+    auto log = loopLog(3000);
+    KeyframeIndex index;
+    ASSERT_TRUE(index.build(loopProcessor(), log.data(), log.size(), 256));
+    std::string path = "/tmp/encoder_to_odom_index_" + std::to_string(getpid());
+    ASSERT_TRUE(index.save(path.c_str()));
+
+    KeyframeIndex loaded;
+    ASSERT_TRUE(loaded.load(path.c_str(), loopProcessor()));
+    ASSERT_EQ(index.getKeyframes().size(), loaded.getKeyframes().size());
+    ASSERT_EQ(index.getDuration(), loaded.getDuration());
+
+    Position original;
+    Position reloaded;
+    ASSERT_TRUE(index.poseAt(log.data(), log.size(), 41234, original));
+    ASSERT_TRUE(loaded.poseAt(log.data(), log.size(), 41234, reloaded));
+    ASSERT_EQ(original.x, reloaded.x);
+    ASSERT_EQ(original.theta, reloaded.theta);
+
+    // Geometry published to a mailbox the caller's processor uses never reaches the lookups
+    GeometryMailbox mailbox;
+    auto attached = loopProcessor();
+    attached.attachGeometryMailbox(&mailbox);
+    ASSERT_TRUE(loaded.load(path.c_str(), attached));
+    mailbox.publish({{1.0f, 1.0f}, {1.0f, 1.0f}, 1.0f});
+    ASSERT_TRUE(loaded.poseAt(log.data(), log.size(), 41234, reloaded));
+    ASSERT_EQ(original.x, reloaded.x);
+
+    // A file from another version of the format is refused
+    FILE* file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(nullptr, file);
+    uint32_t version = KEYFRAME_INDEX_VERSION + 1;
+    ASSERT_EQ(0, fseek(file, sizeof(uint32_t), SEEK_SET));
+    ASSERT_EQ(1u, fwrite(&version, sizeof(version), 1, file));
+    fclose(file);
+    ASSERT_FALSE(loaded.load(path.c_str(), loopProcessor()));
+
+    // So is a truncated file
+    ASSERT_TRUE(index.save(path.c_str()));
+    ASSERT_EQ(0, truncate(path.c_str(), 100));
+    ASSERT_FALSE(loaded.load(path.c_str(), loopProcessor()));
+    unlink(path.c_str());
+    ASSERT_FALSE(loaded.load(path.c_str(), loopProcessor()));
+}
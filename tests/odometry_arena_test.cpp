@@ -0,0 +1,119 @@
+#include "encoder_to_odom/odometry_arena.h"
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/// Heap allocations made by the test binary so far
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+    allocations++;
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+/**
+ * @brief Drive a processor forward in a gentle curve
+ *
+ */
+static void drive(OdometryProcessor& processor, int frames)
+{
+    for (int frame = 1; frame <= frames; frame++)
+    {
+        processor.processFrame({fmodf(frame * 10.0f, THREE_SIXTY),
+                                fmodf(frame * 11.0f, THREE_SIXTY),
+                                static_cast<uint16_t>(frame * 20)});
+    }
+}
+
+// Check processors are created, used, released and reused without touching the heap
+TEST(OdometryArenaTests, NoHeapTraffic)
+{
+    constexpr size_t COUNT = 8;
+    std::vector<unsigned char> memory(OdometryArena::bytesFor(COUNT));
+    OdometryProcessor* processors[COUNT + 1];
+
+    size_t before = allocations;
+    // Start off a byte to check the arena aligns the slots itself
+    OdometryArena arena(memory.data() + 1, memory.size() - 1);
+    for (int round = 0; round < 100; round++)
+    {
+        for (size_t index = 0; index <= COUNT; index++)
+        {
+            processors[index] = arena.create(0.3f, 0.5f, 1.0f, 180.0f);
+        }
+        drive(*processors[0], 50);
+        for (size_t index = 0; index < COUNT; index++)
+        {
+            arena.release(processors[index]);
+        }
+    }
+    size_t after = allocations;
+
+    ASSERT_EQ(before, after);
+    ASSERT_EQ(COUNT - 1, arena.getCapacity());
+    ASSERT_EQ(0u, arena.getSize());
+    // One slot was lost to alignment, so the last create each round found the arena full
+    ASSERT_EQ(nullptr, processors[COUNT]);
+}
+
+// Check slots are handed out again after release and reset
+TEST(OdometryArenaTests, Reuse)
+{
+    std::vector<unsigned char> memory(OdometryArena::bytesFor(2));
+    OdometryArena arena(memory.data(), memory.size());
+    ASSERT_LE(2u, arena.getCapacity());
+
+    auto first = arena.create(0.3f, 0.5f, 1.0f, 180.0f);
+    auto second = arena.create(WheelGeometry{0.3f, 1.0f}, WheelGeometry{0.31f, 1.0f}, 0.5f, 180.0f);
+    ASSERT_NE(nullptr, first);
+    ASSERT_NE(nullptr, second);
+    ASSERT_EQ(2u, arena.getSize());
+
+    arena.release(first);
+    arena.release(nullptr);
+    ASSERT_EQ(1u, arena.getSize());
+    ASSERT_EQ(first, arena.create(0.3f, 0.5f, 1.0f, 180.0f));
+    ASSERT_EQ(0.0f, first->getPosition().x);
+
+    arena.reset();
+    ASSERT_EQ(0u, arena.getSize());
+    ASSERT_EQ(first, arena.create(0.3f, 0.5f, 1.0f, 180.0f));
+
+    OdometryArena empty(memory.data(), 1);
+    ASSERT_EQ(0u, empty.getCapacity());
+    ASSERT_EQ(nullptr, empty.create(0.3f, 0.5f, 1.0f, 180.0f));
+}
+
+// Check a processor moved with memcpy carries on exactly where it left off
+TEST(OdometryArenaTests, Relocate)
+{
+    std::vector<unsigned char> memory(OdometryArena::bytesFor(1));
+    OdometryArena arena(memory.data(), memory.size());
+    auto placed = arena.create(0.3f, 0.5f, 1.0f, 180.0f);
+    OdometryProcessor reference(0.3f, 0.5f, 1.0f, 180.0f);
+    drive(*placed, 100);
+    drive(reference, 100);
+
+    alignas(OdometryProcessor) unsigned char moved[sizeof(OdometryProcessor)];
+    std::memcpy(moved, placed, sizeof(OdometryProcessor));
+    arena.release(placed);
+    auto relocated = reinterpret_cast<OdometryProcessor*>(moved);
+
+    relocated->processFrame({20.0f, 30.0f, 2020});
+    reference.processFrame({20.0f, 30.0f, 2020});
+    ASSERT_EQ(reference.getPosition().x, relocated->getPosition().x);
+    ASSERT_EQ(reference.getPosition().theta, relocated->getPosition().theta);
+    ASSERT_EQ(reference.getDistance().totalDistance, relocated->getDistance().totalDistance);
+}
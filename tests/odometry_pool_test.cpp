@@ -0,0 +1,77 @@
+#include "encoder_to_odom/odometry_pool.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+/**
+ * @brief Recorded log of a robot driving an arc, with wrapping encoder readings and timestamps
+ *
+ */
+std::vector<EncoderFrame> recordLog(size_t frames, float turnRate)
+{
+    std::vector<EncoderFrame> log;
+    float left = 0;
+    float right = 0;
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        left = fmodf(left + 20.0f, THREE_SIXTY);
+        right = fmodf(right + 20.0f + turnRate, THREE_SIXTY);
+        log.push_back({left, right, static_cast<uint16_t>(frame * 20)});
+    }
+    return log;
+}
+
+OdometryProcessor makeProcessor() { return OdometryProcessor(0.3f, 0.5f, 2.0f, 180.0f); }
+
+// Check streams of very different lengths all match processing them one after another
+TEST(OdometryPoolTests, SkewedStreams)
+{
+    constexpr size_t ROBOTS = 40;
+    std::vector<std::vector<EncoderFrame>> logs;
+    for (size_t robot = 0; robot < ROBOTS; robot++)
+    {
+        // One robot has a log far longer than all the others put together
+        size_t frames = robot == 7 ? 60000 : 50 + robot * 37;
+        logs.push_back(recordLog(frames, 0.1f * robot));
+    }
+
+    std::vector<OdometryProcessor> pooled(ROBOTS, makeProcessor());
+    std::vector<RobotStream> streams;
+    for (size_t robot = 0; robot < ROBOTS; robot++)
+    {
+        streams.push_back({&pooled[robot], logs[robot].data(), logs[robot].size()});
+    }
+
+    OdometryPool pool(4);
+    ASSERT_EQ(4u, pool.getThreadCount());
+    pool.process(streams, 256);
+
+    for (size_t robot = 0; robot < ROBOTS; robot++)
+    {
+        auto serial = makeProcessor();
+        for (const auto& frame : logs[robot])
+        {
+            serial.processFrame(frame);
+        }
+        ASSERT_EQ(serial.getPosition().x, pooled[robot].getPosition().x);
+        ASSERT_EQ(serial.getPosition().y, pooled[robot].getPosition().y);
+        ASSERT_EQ(serial.getPosition().theta, pooled[robot].getPosition().theta);
+        ASSERT_EQ(serial.getDistance().totalDistance, pooled[robot].getDistance().totalDistance);
+    }
+}
+
+// Check a pool can be reused and handles more threads than streams
+TEST(OdometryPoolTests, Reuse)
+{
+    auto log = recordLog(1000, 1.0f);
+    OdometryPool pool(8);
+    pool.process({});
+
+    auto first = makeProcessor();
+    auto second = makeProcessor();
+    pool.process({{&first, log.data(), 500}}, 64);
+    pool.process({{&first, log.data() + 500, 500}, {&second, log.data(), log.size()}}, 64);
+
+    ASSERT_EQ(second.getPosition().x, first.getPosition().x);
+    ASSERT_EQ(second.getPosition().theta, first.getPosition().theta);
+}
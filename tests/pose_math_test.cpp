@@ -0,0 +1,52 @@
+#include "encoder_to_odom/pose_math.h"
+#include <gtest/gtest.h>
+
+/**
+ * @brief Check that two poses are the same within a tolerance
+ *
+ */
+void expectPoseNear(const Position& expected, const Position& actual, float tolerance = 1e-4)
+{
+    EXPECT_NEAR(expected.x, actual.x, tolerance);
+    EXPECT_NEAR(expected.y, actual.y, tolerance);
+    EXPECT_NEAR(0.0, normalizeAngle(expected.theta - actual.theta), tolerance);
+}
+
+// Check that composing a pose with its inverse returns to the origin
+TEST(PoseMathTests, ComposeInverse)
+{
+    Position pose = {1.5, -0.5, 2.0};
+
+    expectPoseNear({0, 0, 0}, composePose(pose, inversePose(pose)));
+    expectPoseNear({0, 0, 0}, composePose(inversePose(pose), pose));
+
+    Position step = {1.0, 0.0, PI / 2};
+    expectPoseNear({1.0, 1.0, PI}, composePose(step, step));
+}
+
+// Check that the exponential and logarithm maps undo each other, including around the small
+// angle cutoff
+TEST(PoseMathTests, ExponentialLogarithm)
+{
+    Position twists[] = {{1.0, 0.0, 0.0}, {0.3, 0.1, 1e-5}, {0.5, -0.2, 0.7}, {2.0, 0.0, -3.0}};
+    for (auto twist : twists)
+    {
+        expectPoseNear(twist, logarithmMap(exponentialMap(twist)));
+    }
+
+    // Quarter circle of radius 1
+    expectPoseNear({1.0, 1.0, PI / 2}, exponentialMap({PI / 2, 0.0, PI / 2}));
+}
+
+// Check that interpolating follows the arc between two poses
+TEST(PoseMathTests, Interpolate)
+{
+    Position start = {0.0, 0.0, 0.0};
+    Position end = {1.0, 1.0, PI / 2};
+
+    Position middle = interpolatePose(start, end, 0.5);
+    expectPoseNear({sinf(PI / 4), 1.0f - cosf(PI / 4), PI / 4}, middle);
+
+    expectPoseNear(start, interpolatePose(start, end, 0.0));
+    expectPoseNear(end, interpolatePose(start, end, 1.0));
+}
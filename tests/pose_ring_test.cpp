@@ -0,0 +1,157 @@
+#include "encoder_to_odom/pose_ring.h"
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+
+std::string ringName(const char* test)
+{
+    return std::string("/encoder_to_odom_") + test + "_" + std::to_string(getpid());
+}
+
+OdometryState ringState(int frame)
+{
+    OdometryState state = {};
+    state.position = {0.5f * frame, -0.5f * frame, 0.001f * frame};
+    state.distance = {0.5f, 0.5f * frame};
+    state.timestamp = static_cast<uint16_t>(frame);
+    return state;
+}
+
+// Check a reader sees frames in order and the newest frame
+TEST(PoseRingTests, ReadInOrder)
+{
+    auto name = ringName("order");
+    PoseRingWriter writer;
+    ASSERT_TRUE(writer.create(name.c_str(), 8));
+    ASSERT_FALSE(writer.create(name.c_str(), 8));
+
+    PoseRingReader reader;
+    ASSERT_TRUE(reader.open(name.c_str()));
+    PosePacket packet;
+    ASSERT_FALSE(reader.next(packet));
+    ASSERT_FALSE(reader.latest(packet));
+
+    for (int frame = 0; frame < 5; frame++)
+    {
+        writer.publish(ringState(frame));
+    }
+    for (int frame = 0; frame < 5; frame++)
+    {
+        ASSERT_TRUE(reader.next(packet));
+        ASSERT_EQ(static_cast<uint32_t>(frame), packet.sequence);
+        ASSERT_FLOAT_EQ(0.5f * frame, packet.x);
+    }
+    ASSERT_FALSE(reader.next(packet));
+    ASSERT_TRUE(reader.latest(packet));
+    ASSERT_EQ(4u, packet.sequence);
+    ASSERT_EQ(0u, reader.getMissedFrames());
+
+    // A reader opened later starts at the next frame
+    PoseRingReader lateReader;
+    ASSERT_TRUE(lateReader.open(name.c_str()));
+    ASSERT_FALSE(lateReader.next(packet));
+    writer.publish(ringState(5));
+    ASSERT_TRUE(lateReader.next(packet));
+    ASSERT_EQ(5u, packet.sequence);
+}
+
+// Check a reader that falls behind skips to the oldest frame still held
+TEST(PoseRingTests, Overrun)
+{
+    auto name = ringName("overrun");
+    PoseRingWriter writer;
+    ASSERT_TRUE(writer.create(name.c_str(), 4));
+    PoseRingReader reader;
+    ASSERT_TRUE(reader.open(name.c_str()));
+
+    for (int frame = 0; frame < 10; frame++)
+    {
+        writer.publish(ringState(frame));
+    }
+    PosePacket packet;
+    ASSERT_TRUE(reader.next(packet));
+    ASSERT_EQ(6u, packet.sequence);
+    ASSERT_EQ(6u, reader.getMissedFrames());
+}
+
+// Check frames read while the writer is publishing are never torn
+TEST(PoseRingTests, ConcurrentWriter)
+{
+    auto name = ringName("concurrent");
+    PoseRingWriter writer;
+    ASSERT_TRUE(writer.create(name.c_str(), 16));
+    PoseRingReader reader;
+    ASSERT_TRUE(reader.open(name.c_str()));
+
+    constexpr int FRAMES = 200000;
+    std::thread publisher(
+        [&]()
+        {
+            for (int frame = 0; frame < FRAMES; frame++)
+            {
+                writer.publish(ringState(frame));
+            }
+        });
+
+    bool consistent = true;
+    uint64_t received = 0;
+    int64_t previous = -1;
+    PosePacket packet;
+    while (previous < FRAMES - 1)
+    {
+        if (!reader.next(packet))
+        {
+            continue;
+        }
+        received++;
+        consistent &= static_cast<int64_t>(packet.sequence) > previous;
+        consistent &= packet.x == 0.5f * packet.sequence && packet.y == -packet.x;
+        consistent &= packet.timestamp == static_cast<uint16_t>(packet.sequence);
+        previous = packet.sequence;
+    }
+    publisher.join();
+
+    ASSERT_TRUE(consistent);
+    ASSERT_EQ(static_cast<uint64_t>(FRAMES), received + reader.getMissedFrames());
+}
+
+// Check readers give up on a frame the writer stopped halfway through overwriting
+TEST(PoseRingTests, WriterDiedMidWrite)
+{
+    auto name = ringName("died");
+    PoseRingWriter writer;
+    ASSERT_TRUE(writer.create(name.c_str(), 1));
+    PoseRingReader reader;
+    ASSERT_TRUE(reader.open(name.c_str()));
+    writer.publish(ringState(0));
+
+    // Mark the only slot as being written with frame 1, as a writer killed in publish() leaves it
+    int descriptor = shm_open(name.c_str(), O_RDWR, 0);
+    ASSERT_GE(descriptor, 0);
+    size_t size = sizeof(PoseRingHeader) + sizeof(PoseRingSlot);
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    ASSERT_NE(MAP_FAILED, memory);
+    auto slot = reinterpret_cast<PoseRingSlot*>(static_cast<PoseRingHeader*>(memory) + 1);
+    slot->stamp.store(3, std::memory_order_release);
+
+    PosePacket packet;
+    ASSERT_FALSE(reader.latest(packet));
+    ASSERT_FALSE(reader.next(packet));
+    ASSERT_EQ(1u, reader.getMissedFrames());
+    munmap(memory, size);
+}
+
+// Check readers refuse rings that do not exist
+TEST(PoseRingTests, MissingRing)
+{
+    PoseRingReader reader;
+    ASSERT_FALSE(reader.open(ringName("missing").c_str()));
+    PosePacket packet;
+    ASSERT_FALSE(reader.next(packet));
+}
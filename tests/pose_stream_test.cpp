@@ -0,0 +1,143 @@
+#include "encoder_to_odom/pose_stream.h"
+#include <gtest/gtest.h>
+
+#include <netinet/in.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Non-blocking datagram socket bound to an ephemeral localhost UDP port
+ *
+ */
+int bindUdp(uint16_t& port)
+{
+    int receiver = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length);
+    port = ntohs(address.sin_port);
+    return receiver;
+}
+
+/**
+ * @brief Read every packet waiting on a socket
+ *
+ */
+std::vector<PosePacket> receiveAll(int receiver)
+{
+    std::vector<PosePacket> packets;
+    char buffer[64];
+    ssize_t size;
+    while ((size = recv(receiver, buffer, sizeof(buffer), 0)) > 0)
+    {
+        PosePacket packet;
+        EXPECT_TRUE(decodePosePacket(buffer, size, packet));
+        packets.push_back(packet);
+    }
+    return packets;
+}
+
+OdometryState frameState(int frame)
+{
+    OdometryState state = {};
+    state.position = {0.1f * frame, 0.2f * frame, 0.01f * frame};
+    state.velocity = {1.0f, 0.5f};
+    state.distance = {0.1f, 0.1f * frame};
+    state.timestamp = static_cast<uint16_t>(1000 * frame);
+    return state;
+}
+
+// Check each UDP subscriber gets every decimation-th frame once the batch is flushed
+TEST(PoseStreamTests, UdpDecimation)
+{
+    uint16_t fastPort;
+    uint16_t slowPort;
+    int fast = bindUdp(fastPort);
+    int slow = bindUdp(slowPort);
+
+    PoseStreamServer server;
+    ASSERT_TRUE(server.addUdpSubscriber("127.0.0.1", fastPort));
+    ASSERT_TRUE(server.addUdpSubscriber("127.0.0.1", slowPort, 3));
+
+    // Nothing goes out until a full batch is queued
+    for (int frame = 0; frame < STREAM_BATCH_FRAMES - 1; frame++)
+    {
+        server.publish(frameState(frame));
+    }
+    ASSERT_TRUE(receiveAll(fast).empty());
+
+    for (int frame = STREAM_BATCH_FRAMES - 1; frame < 10; frame++)
+    {
+        server.publish(frameState(frame));
+    }
+    server.flush();
+
+    auto fastPackets = receiveAll(fast);
+    ASSERT_EQ(10u, fastPackets.size());
+    for (int frame = 0; frame < 10; frame++)
+    {
+        ASSERT_EQ(static_cast<uint32_t>(frame), fastPackets[frame].sequence);
+        ASSERT_FLOAT_EQ(0.1f * frame, fastPackets[frame].x);
+        ASSERT_FLOAT_EQ(0.1f * frame, fastPackets[frame].totalDistance);
+        ASSERT_EQ(static_cast<uint16_t>(1000 * frame), fastPackets[frame].timestamp);
+    }
+
+    auto slowPackets = receiveAll(slow);
+    ASSERT_EQ(4u, slowPackets.size());
+    ASSERT_EQ(9u, slowPackets[3].sequence);
+    ASSERT_EQ(0u, server.getDroppedPackets());
+
+    close(fast);
+    close(slow);
+}
+
+// Check frames reach a Unix domain subscriber and a missing one only counts drops
+TEST(PoseStreamTests, UnixSocket)
+{
+    std::string path = "/tmp/encoder_to_odom_stream_" + std::to_string(getpid());
+    unlink(path.c_str());
+    int receiver = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    ASSERT_EQ(0, bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+
+    PoseStreamServer server;
+    ASSERT_TRUE(server.addUnixSubscriber(path.c_str(), 2));
+    ASSERT_TRUE(server.addUnixSubscriber((path + "_missing").c_str()));
+    for (int frame = 0; frame < 4; frame++)
+    {
+        server.publish(frameState(frame));
+    }
+    ASSERT_EQ(2, server.flush());
+
+    auto packets = receiveAll(receiver);
+    ASSERT_EQ(2u, packets.size());
+    ASSERT_EQ(2u, packets[1].sequence);
+    ASSERT_FLOAT_EQ(0.02f, packets[1].theta);
+    ASSERT_EQ(4u, server.getDroppedPackets());
+
+    close(receiver);
+    unlink(path.c_str());
+}
+
+// Check bad subscribers and packets are refused
+TEST(PoseStreamTests, Rejects)
+{
+    PoseStreamServer server;
+    ASSERT_FALSE(server.addUdpSubscriber("not an address", 9000));
+    ASSERT_FALSE(server.addUdpSubscriber("127.0.0.1", 9000, 0));
+    ASSERT_FALSE(server.addUnixSubscriber(std::string(200, 'a').c_str()));
+
+    PosePacket packet = makePosePacket(frameState(1), 7);
+    PosePacket decoded;
+    ASSERT_FALSE(decodePosePacket(&packet, sizeof(packet) - 1, decoded));
+    packet.magic = 0;
+    ASSERT_FALSE(decodePosePacket(&packet, sizeof(packet), decoded));
+}
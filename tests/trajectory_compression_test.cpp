@@ -0,0 +1,118 @@
+#include "encoder_to_odom/trajectory_compression.h"
+#include "encoder_to_odom/pose_math.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+/**
+ * @brief Full rate poses of a robot driving straight, along an arc, turning in place and reversing
+ *
+ */
+std::vector<TimedPose> drivenPoses()
+{
+    std::vector<TimedPose> poses;
+    Position pose = {2.0f, -1.0f, 3.0f};
+    for (int frame = 0; frame < 20000; frame++)
+    {
+        float forward = 0.01f;
+        float turn = 0.0f;
+        int phase = (frame / 2500) % 4;
+        if (phase == 1)
+        {
+            turn = 0.004f;
+        }
+        else if (phase == 2)
+        {
+            forward = 0.0f;
+            turn = -0.01f;
+        }
+        else if (phase == 3)
+        {
+            forward = -0.005f;
+            turn = 0.001f * sinf(frame * 0.01f);
+        }
+        pose = composePose(pose, {forward, 0.0f, turn});
+        poses.push_back({frame * 20 + (frame % 3), pose});
+    }
+    return poses;
+}
+
+// Check every pose is within the errors of the simplified trajectory and most are dropped
+TEST(TrajectoryCompressionTests, SimplifierBound)
+{
+    constexpr float POSITION_ERROR = 0.005f;
+    constexpr float HEADING_ERROR = 0.01f;
+    auto poses = drivenPoses();
+    TrajectorySimplifier simplifier(POSITION_ERROR, HEADING_ERROR);
+    std::vector<TimedPose> vertices;
+    TimedPose vertex;
+    for (const auto& pose : poses)
+    {
+        if (simplifier.push(pose, vertex))
+        {
+            vertices.push_back(vertex);
+        }
+    }
+    ASSERT_TRUE(simplifier.finish(vertex));
+    vertices.push_back(vertex);
+    ASSERT_FALSE(simplifier.finish(vertex));
+    ASSERT_EQ(poses.front().time, vertices.front().time);
+    ASSERT_EQ(poses.back().time, vertices.back().time);
+    ASSERT_LT(vertices.size(), poses.size() / 20);
+
+    size_t segment = 0;
+    for (const auto& pose : poses)
+    {
+        while (vertices[segment + 1].time < pose.time)
+        {
+            segment++;
+        }
+        auto simplified = interpolateVertices(vertices[segment], vertices[segment + 1], pose.time);
+        ASSERT_LE(hypotf(simplified.x - pose.pose.x, simplified.y - pose.pose.y),
+                  POSITION_ERROR + 1e-5f);
+        ASSERT_LE(fabsf(normalizeAngle(simplified.theta - pose.pose.theta)), HEADING_ERROR + 1e-5f);
+    }
+}
+
+// Check quantized poses round trip within the errors and stay small
+TEST(TrajectoryCompressionTests, DeltaEncoding)
+{
+    constexpr float POSITION_ERROR = 0.001f;
+    constexpr float HEADING_ERROR = 0.001f;
+    auto poses = drivenPoses();
+    PoseDeltaEncoder encoder(POSITION_ERROR, HEADING_ERROR);
+    std::vector<uint8_t> encoded;
+    uint8_t buffer[POSE_DELTA_MAX_SIZE];
+    for (const auto& pose : poses)
+    {
+        size_t size = encoder.encode(pose, buffer);
+        ASSERT_LE(size, POSE_DELTA_MAX_SIZE);
+        encoded.insert(encoded.end(), buffer, buffer + size);
+    }
+    // A raw TimedPose is 24 bytes
+    ASSERT_LT(encoded.size(), poses.size() * 6);
+
+    PoseDeltaDecoder decoder(POSITION_ERROR, HEADING_ERROR);
+    size_t offset = 0;
+    size_t consumed;
+    TimedPose decoded;
+    for (const auto& pose : poses)
+    {
+        ASSERT_TRUE(decoder.decode(encoded.data() + offset, encoded.size() - offset, consumed,
+                                   decoded));
+        offset += consumed;
+        ASSERT_EQ(pose.time, decoded.time);
+        ASSERT_LE(hypotf(decoded.pose.x - pose.pose.x, decoded.pose.y - pose.pose.y),
+                  POSITION_ERROR + 1e-6f);
+        ASSERT_LE(fabsf(normalizeAngle(decoded.pose.theta - pose.pose.theta)),
+                  HEADING_ERROR + 1e-6f);
+    }
+    ASSERT_EQ(encoded.size(), offset);
+
+    // A partial record is left for when the rest arrives
+    encoder.reset();
+    decoder.reset();
+    size_t size = encoder.encode(poses[0], buffer);
+    ASSERT_FALSE(decoder.decode(buffer, size - 1, consumed, decoded));
+    ASSERT_EQ(0u, consumed);
+}
@@ -0,0 +1,76 @@
+#include "encoder_to_odom/trajectory.h"
+#include "encoder_to_odom/pose_math.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+constexpr float LOG_CIRCUMFERENCE = 0.3f;
+constexpr float LOG_WHEEL_BASE = 0.5f;
+constexpr float LOG_GEAR_RATIO = 2.0f;
+constexpr float LOG_ROLLOVER = 180.0f;
+
+/**
+ * @brief Recorded log of a robot weaving along, the left encoder counts down when driving forward
+ *
+ */
+std::vector<EncoderFrame> weavingLog(size_t frames)
+{
+    std::vector<EncoderFrame> log;
+    float left = 100.0f;
+    float right = 200.0f;
+    for (size_t frame = 0; frame < frames; frame++)
+    {
+        float turn = 8.0f * sinf(frame * 0.001f);
+        left = fmodf(left - 25.0f + turn + THREE_SIXTY, THREE_SIXTY);
+        right = fmodf(right + 25.0f + turn, THREE_SIXTY);
+        log.push_back({left, right, static_cast<uint16_t>(frame * 10)});
+    }
+    return log;
+}
+
+TrajectoryConfig logConfig()
+{
+    WheelGeometry wheel = {LOG_CIRCUMFERENCE, LOG_GEAR_RATIO};
+    return {{wheel, wheel, LOG_WHEEL_BASE}, LOG_ROLLOVER, true, false, {1.0f, 2.0f, 0.5f}};
+}
+
+// Check the parallel reconstruction follows a processor replaying the same log
+TEST(TrajectoryTests, MatchesProcessor)
+{
+    auto log = weavingLog(50000);
+    std::vector<Position> poses(log.size());
+    reconstructTrajectory(logConfig(), log.data(), log.size(), poses.data(), 8);
+
+    OdometryProcessor processor(LOG_CIRCUMFERENCE, LOG_WHEEL_BASE, LOG_GEAR_RATIO, LOG_ROLLOVER,
+                                true, false);
+    processor.setSettlePolicy({SettlePolicy::FIXED_COUNT, 1});
+    processor.processFrame(log[0]);
+    auto start = logConfig().start;
+    float largestError = 0.0f;
+    for (size_t frame = 1; frame < log.size(); frame++)
+    {
+        processor.processFrame(log[frame]);
+        auto expected = composePose(start, processor.getPosition());
+        largestError = std::max(largestError, fabsf(expected.x - poses[frame].x));
+        largestError = std::max(largestError, fabsf(expected.y - poses[frame].y));
+    }
+    ASSERT_LT(largestError, 0.01f);
+    ASSERT_NEAR(1.0f, poses[0].x, 1e-6);
+}
+
+// Check the thread count does not change the result beyond rounding
+TEST(TrajectoryTests, ThreadCounts)
+{
+    auto log = weavingLog(3 * TRAJECTORY_MIN_BLOCK + 17);
+    std::vector<Position> serial(log.size());
+    std::vector<Position> parallel(log.size());
+    reconstructTrajectory(logConfig(), log.data(), log.size(), serial.data(), 1);
+    reconstructTrajectory(logConfig(), log.data(), log.size(), parallel.data(), 3);
+
+    for (size_t frame = 0; frame < log.size(); frame++)
+    {
+        ASSERT_NEAR(serial[frame].x, parallel[frame].x, 1e-3);
+        ASSERT_NEAR(serial[frame].y, parallel[frame].y, 1e-3);
+        ASSERT_NEAR(serial[frame].theta, parallel[frame].theta, 1e-3);
+    }
+}